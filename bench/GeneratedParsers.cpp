@@ -0,0 +1,149 @@
+// Checks the generated recursive-descent parsers against the table-driven LL1Parser and times both.
+// Run from the repository root; regenerate generated/ with the "generate" test first if the rules changed.
+#include "LL1Parser.hpp"
+#include "ExpressionRecognizer.hpp"
+#include "ExpressionEvaluator.hpp"
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	const std::string RecognizerRules = "test/test3/rules.txt";
+	const std::string EvaluatorRules = "test/test4/rules.txt";
+	const std::string EvaluatorActions = "test/test4/L-SDT.txt";
+
+	class NullBuffer : public std::streambuf
+	{
+	protected:
+		int overflow(int c) override { return c; }
+		std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+	};
+
+	// LL1Parser reports through std::cout; this swaps in another buffer for as long as it lives.
+	class Redirect
+	{
+	public:
+		explicit Redirect(std::streambuf* buffer) : m_previous(std::cout.rdbuf(buffer)) {}
+		~Redirect() { std::cout.rdbuf(m_previous); }
+
+	private:
+		std::streambuf* m_previous;
+	};
+
+	struct Evaluation
+	{
+		bool accepted;
+		std::int64_t value;
+	};
+
+	Evaluation tableEvaluate(PL0::LL1Parser& parser, const PL0::Lexer& lexer, const PL0::TokenBuffer& tokens)
+	{
+		std::stringstream output;
+		{
+			Redirect redirect(output.rdbuf());
+			parser.semanticParse(lexer, tokens);
+		}
+		// semanticParse prints "Parse successfully" followed by the value once the start symbol is reduced.
+		std::string text = output.str();
+		size_t found = text.find("Parse successfully\n");
+		if (found == std::string::npos || text.find("Parse failed") != std::string::npos)
+			return { false, 0 };
+		return { true, std::stoll(text.substr(found + 19)) };
+	}
+
+	template <typename Function>
+	double millisecondsPerRun(size_t runs, Function function)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < runs; i++)
+			function();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count() / runs;
+	}
+
+	// Sums of products of small numbers, so the table engine's int values cannot overflow.
+	std::string syntheticExpression(size_t terms)
+	{
+		std::string text;
+		for (size_t i = 0; i < terms; i++)
+		{
+			if (i != 0)
+				text += i % 3 ? " + " : " - ";
+			text += std::format("({} * {} - {} / {})", i % 7 + 1, i % 5 + 2, i % 11, i % 3 + 1);
+		}
+		return text;
+	}
+
+	size_t checkRecognizer(PL0::LL1Parser& parser, const std::string& source)
+	{
+		PL0::Lexer lexer(PL0::SourceText{ source });
+		PL0::TokenBuffer tokens = lexer.tokenizeAll();
+		PL0::Generated::ExpressionRecognizer recognizer;
+
+		NullBuffer sink;
+		Redirect redirect(&sink);
+		bool table = parser.parse(lexer, tokens);
+		bool generated = recognizer.parse(tokens).accepted;
+		if (table == generated)
+			return 0;
+		std::cerr << std::format("recognizer differs on \"{}\": table {}, generated {}\n", source, table, generated);
+		return 1;
+	}
+
+	size_t checkEvaluator(PL0::LL1Parser& parser, const std::string& source)
+	{
+		PL0::Lexer lexer(PL0::SourceText{ source });
+		PL0::TokenBuffer tokens = lexer.tokenizeAll();
+		PL0::Generated::ExpressionEvaluator evaluator;
+
+		std::int64_t value = 0;
+		PL0::ParseResult generated = evaluator.parse(tokens, &value);
+		Evaluation table = tableEvaluate(parser, lexer, tokens);
+		if (table.accepted == generated.accepted && (!table.accepted || table.value == value))
+			return 0;
+		std::cerr << std::format("evaluator differs on \"{}\": table {} {}, generated {} {}\n",
+			source, table.accepted, table.value, generated.accepted, value);
+		return 1;
+	}
+}
+
+int main()
+{
+	PL0::LL1Parser recognizer(RecognizerRules);
+	PL0::LL1Parser evaluator(EvaluatorRules);
+	evaluator.getL_sdtFile(EvaluatorActions);
+
+	size_t differences = 0;
+	for (int i = 1; i <= 10; i++)
+	{
+		PL0::Lexer expression(std::format("test/test3/example{}.pl0", i));
+		differences += checkRecognizer(recognizer, std::string(expression.source()));
+		PL0::Lexer arithmetic(std::format("test/test4/example{}.pl0", i));
+		differences += checkEvaluator(evaluator, std::string(arithmetic.source()));
+	}
+	std::string expression = syntheticExpression(500);
+	differences += checkRecognizer(recognizer, expression);
+	differences += checkEvaluator(evaluator, expression);
+	std::cout << std::format("{} differences\n", differences);
+
+	PL0::Lexer lexer(PL0::SourceText{ expression });
+	PL0::TokenBuffer tokens = lexer.tokenizeAll();
+	PL0::Generated::ExpressionRecognizer generatedRecognizer;
+	PL0::Generated::ExpressionEvaluator generatedEvaluator;
+	NullBuffer sink;
+	double tableParse, tableSemantic;
+	{
+		Redirect redirect(&sink);
+		tableParse = millisecondsPerRun(20, [&] { recognizer.parse(lexer, tokens); });
+		tableSemantic = millisecondsPerRun(2, [&] { evaluator.semanticParse(lexer, tokens); });
+	}
+	double generatedParse = millisecondsPerRun(1000, [&] { generatedRecognizer.parse(tokens); });
+	double generatedSemantic = millisecondsPerRun(1000, [&] { generatedEvaluator.parse(tokens); });
+
+	std::cout << std::format("{} tokens\n", tokens.size());
+	std::cout << std::format("recognise: table {:10.3f} ms, generated {:10.3f} ms\n", tableParse, generatedParse);
+	std::cout << std::format("evaluate:  table {:10.3f} ms, generated {:10.3f} ms\n", tableSemantic, generatedSemantic);
+	return differences == 0 ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+// Generated by ParserGenerator from test/test4/rules.txt and test/test4/L-SDT.txt; do not edit.
+#pragma once
+#include "LL1Parser.hpp"
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+
+namespace PL0::Generated
+{
+	class ExpressionEvaluator
+	{
+	public:
+		ParseResult parse(const TokenBuffer& tokens, std::int64_t* value = nullptr)
+		{
+			m_tokens = &tokens;
+			m_position = 0;
+			load();
+			try
+			{
+				std::int64_t result = parseE(0);
+				if (m_lookahead != '#')
+					return { false, m_position, "Parse failed,extra symbols appeared." };
+				if (value != nullptr)
+					*value = result;
+				return { true, 0, "Parse successfully!" };
+			}
+			catch (const Failure& failure)
+			{
+				return { false, failure.token, failure.message };
+			}
+		}
+
+	private:
+		struct Failure
+		{
+			size_t token;
+			std::string message;
+		};
+
+		void load()
+		{
+			m_lookahead = m_position < m_tokens->size() ? terminalOf(m_tokens->kinds[m_position]) : '#';
+		}
+
+		void match(char terminal)
+		{
+			if (m_lookahead != terminal)
+				fail(std::format("Signal {} not found in expression", terminal));
+			m_position++;
+			load();
+		}
+
+		std::int64_t number() const { return m_tokens->values[m_position]; }
+
+		[[noreturn]] void fail(std::string message)
+		{
+			throw Failure{ m_position, std::move(message) };
+		}
+
+		std::int64_t parseE(std::int64_t inherited)
+		{
+			std::int64_t value = inherited;
+			switch (m_lookahead)
+			{
+			case 'n':
+			case '(':
+			{
+				// E->TG
+				std::int64_t v1 = parseT(value);
+				// {1}
+				value = v1;
+				std::int64_t v2 = parseG(value);
+				// {2}
+				value = v2;
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for E and {}", m_lookahead));
+			}
+			return value;
+		}
+
+		std::int64_t parseG(std::int64_t inherited)
+		{
+			std::int64_t value = inherited;
+			switch (m_lookahead)
+			{
+			case '+':
+			{
+				// G->+TG
+				match('+');
+				std::int64_t v2 = parseT(value);
+				// {3}
+				if (std::optional<std::int64_t> result = evaluateBuiltin(BuiltinAction::ADD, value, v2))
+					value = *result;
+				else
+					fail("Error: Integer overflow");
+				std::int64_t v3 = parseG(value);
+				// {4}
+				value = v3;
+				break;
+			}
+			case '-':
+			{
+				// G->-TG
+				match('-');
+				std::int64_t v2 = parseT(value);
+				// {5}
+				if (std::optional<std::int64_t> result = evaluateBuiltin(BuiltinAction::SUB, value, v2))
+					value = *result;
+				else
+					fail("Error: Integer overflow");
+				std::int64_t v3 = parseG(value);
+				// {6}
+				value = v3;
+				break;
+			}
+			case ')':
+			case '#':
+			{
+				// G->e
+				// {7}
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for G and {}", m_lookahead));
+			}
+			return value;
+		}
+
+		std::int64_t parseT(std::int64_t inherited)
+		{
+			std::int64_t value = inherited;
+			switch (m_lookahead)
+			{
+			case 'n':
+			case '(':
+			{
+				// T->FS
+				std::int64_t v1 = parseF(value);
+				// {8}
+				value = v1;
+				std::int64_t v2 = parseS(value);
+				// {9}
+				value = v2;
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for T and {}", m_lookahead));
+			}
+			return value;
+		}
+
+		std::int64_t parseS(std::int64_t inherited)
+		{
+			std::int64_t value = inherited;
+			switch (m_lookahead)
+			{
+			case '*':
+			{
+				// S->*FS
+				match('*');
+				std::int64_t v2 = parseF(value);
+				// {10}
+				if (std::optional<std::int64_t> result = evaluateBuiltin(BuiltinAction::MUL, value, v2))
+					value = *result;
+				else
+					fail("Error: Integer overflow");
+				std::int64_t v3 = parseS(value);
+				// {11}
+				value = v3;
+				break;
+			}
+			case '/':
+			{
+				// S->/FS
+				match('/');
+				std::int64_t v2 = parseF(value);
+				// {12}
+				if (v2 == 0)
+					fail("Error: Division by zero");
+				if (std::optional<std::int64_t> result = evaluateBuiltin(BuiltinAction::DIV, value, v2))
+					value = *result;
+				else
+					fail("Error: Integer overflow");
+				std::int64_t v3 = parseS(value);
+				// {13}
+				value = v3;
+				break;
+			}
+			case '+':
+			case '-':
+			case ')':
+			case '#':
+			{
+				// S->e
+				// {14}
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for S and {}", m_lookahead));
+			}
+			return value;
+		}
+
+		std::int64_t parseF(std::int64_t inherited)
+		{
+			std::int64_t value = inherited;
+			switch (m_lookahead)
+			{
+			case 'n':
+			{
+				// F->n
+				std::int64_t v1 = number();
+				match('n');
+				// {15}
+				value = v1;
+				break;
+			}
+			case '(':
+			{
+				// F->(E)
+				match('(');
+				std::int64_t v2 = parseE(value);
+				// {16}
+				value = v2;
+				match(')');
+				// {17}
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for F and {}", m_lookahead));
+			}
+			return value;
+		}
+
+	private:
+		const TokenBuffer* m_tokens = nullptr;
+		size_t m_position = 0;
+		char m_lookahead = '#';
+	};
+}
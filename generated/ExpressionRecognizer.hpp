@@ -0,0 +1,222 @@
+// Generated by ParserGenerator from test/test3/rules.txt; do not edit.
+#pragma once
+#include "LL1Parser.hpp"
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+
+namespace PL0::Generated
+{
+	class ExpressionRecognizer
+	{
+	public:
+		ParseResult parse(const TokenBuffer& tokens)
+		{
+			m_tokens = &tokens;
+			m_position = 0;
+			load();
+			try
+			{
+				parseE();
+				if (m_lookahead != '#')
+					return { false, m_position, "Parse failed,extra symbols appeared." };
+				return { true, 0, "Parse successfully!" };
+			}
+			catch (const Failure& failure)
+			{
+				return { false, failure.token, failure.message };
+			}
+		}
+
+	private:
+		struct Failure
+		{
+			size_t token;
+			std::string message;
+		};
+
+		void load()
+		{
+			m_lookahead = m_position < m_tokens->size() ? terminalOf(m_tokens->kinds[m_position]) : '#';
+		}
+
+		void match(char terminal)
+		{
+			if (m_lookahead != terminal)
+				fail(std::format("Signal {} not found in expression", terminal));
+			m_position++;
+			load();
+		}
+
+		[[noreturn]] void fail(std::string message)
+		{
+			throw Failure{ m_position, std::move(message) };
+		}
+
+		void parseE()
+		{
+			switch (m_lookahead)
+			{
+			case '+':
+			{
+				// E->+B
+				match('+');
+				parseB();
+				break;
+			}
+			case '-':
+			{
+				// E->-B
+				match('-');
+				parseB();
+				break;
+			}
+			case 'i':
+			case 'n':
+			case '(':
+			{
+				// E->B
+				parseB();
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for E and {}", m_lookahead));
+			}
+		}
+
+		void parseB()
+		{
+			switch (m_lookahead)
+			{
+			case 'i':
+			case 'n':
+			case '(':
+			{
+				// B->TG
+				parseT();
+				parseG();
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for B and {}", m_lookahead));
+			}
+		}
+
+		void parseG()
+		{
+			switch (m_lookahead)
+			{
+			case '+':
+			{
+				// G->+TG
+				match('+');
+				parseT();
+				parseG();
+				break;
+			}
+			case '-':
+			{
+				// G->-TG
+				match('-');
+				parseT();
+				parseG();
+				break;
+			}
+			case ')':
+			case '#':
+			{
+				// G->e
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for G and {}", m_lookahead));
+			}
+		}
+
+		void parseT()
+		{
+			switch (m_lookahead)
+			{
+			case 'i':
+			case 'n':
+			case '(':
+			{
+				// T->FS
+				parseF();
+				parseS();
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for T and {}", m_lookahead));
+			}
+		}
+
+		void parseS()
+		{
+			switch (m_lookahead)
+			{
+			case '*':
+			{
+				// S->*FS
+				match('*');
+				parseF();
+				parseS();
+				break;
+			}
+			case '/':
+			{
+				// S->/FS
+				match('/');
+				parseF();
+				parseS();
+				break;
+			}
+			case '+':
+			case '-':
+			case ')':
+			case '#':
+			{
+				// S->e
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for S and {}", m_lookahead));
+			}
+		}
+
+		void parseF()
+		{
+			switch (m_lookahead)
+			{
+			case 'i':
+			{
+				// F->i
+				match('i');
+				break;
+			}
+			case 'n':
+			{
+				// F->n
+				match('n');
+				break;
+			}
+			case '(':
+			{
+				// F->(B)
+				match('(');
+				parseB();
+				match(')');
+				break;
+			}
+			default:
+				fail(std::format("Error: No production found for F and {}", m_lookahead));
+			}
+		}
+
+	private:
+		const TokenBuffer* m_tokens = nullptr;
+		size_t m_position = 0;
+		char m_lookahead = '#';
+	};
+}
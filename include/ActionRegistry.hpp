@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief What a semantic action is called with.
+	 */
+	struct ActionContext
+	{
+		std::int64_t value;    // Handed to the action: an inherited value, or the synthesized value of the symbol before it.
+		std::int64_t operand;  // Binary actions only: the synthesized value of the nonterminal before the action.
+		void* user = nullptr;  // The registry's user pointer, for schemes that build something outside the stack.
+	};
+
+	enum class BuiltinAction : std::uint8_t
+	{
+		COPY,  // value
+		ADD,   // value + operand
+		SUB,   // value - operand
+		MUL,   // value * operand
+		DIV    // value / operand; a zero operand throws ActionFailed.
+	};
+
+	/**
+	 * @brief `action` applied to `value` and `operand`, or nothing if the result does not fit in
+	 *        64 bits or the operand of DIV is 0. Overflow is checked before it can happen.
+	 */
+	constexpr std::optional<std::int64_t> evaluateBuiltin(BuiltinAction action, std::int64_t value, std::int64_t operand)
+	{
+		constexpr std::int64_t max = std::numeric_limits<std::int64_t>::max();
+		constexpr std::int64_t min = std::numeric_limits<std::int64_t>::min();
+		switch (action)
+		{
+		case BuiltinAction::COPY:
+			return value;
+		case BuiltinAction::ADD:
+			if (operand > 0 ? value > max - operand : value < min - operand)
+				return std::nullopt;
+			return value + operand;
+		case BuiltinAction::SUB:
+			if (operand < 0 ? value > max + operand : value < min + operand)
+				return std::nullopt;
+			return value - operand;
+		case BuiltinAction::MUL:
+			if (value > 0 ? (operand > 0 ? value > max / operand : operand < min / value)
+				: (operand > 0 ? value < min / operand : value != 0 && operand < max / value))
+				return std::nullopt;
+			return value * operand;
+		default:
+			if (operand == 0 || (value == min && operand == -1))
+				return std::nullopt;
+			return value / operand;
+		}
+	}
+
+	/**
+	 * @brief Binds the `{n}` action numbers of an L-SDT file to the code semanticParse runs for them.
+	 *
+	 * @note Bindings live in a table indexed by number, so running an action is one indexed call.
+	 *       A binary action takes the synthesized value of the nonterminal right before it as its
+	 *       operand and the inherited value as `value`, as in "G->+T{3}G{4}"; the inherited value of
+	 *       a production goes to its first binary action if it has one. An action's result goes to
+	 *       the nearest entry below it on the semantic stack that is not a terminal. Numbers with no
+	 *       binding pass nothing on, nor does an action reached without a value; a binary action
+	 *       missing either side fails the parse. The number hook, if bound, turns each matched literal into the
+	 *       value it carries, which lets a scheme work on something other than plain numbers.
+	 *       Values are 64-bit; a scheme that emits code or builds a structure can keep its state
+	 *       behind `setUser`, which every call receives as `ActionContext::user`. An action that
+	 *       throws ActionFailed fails the parse with its message instead of ending the program;
+	 *       the built-in arithmetic throws it on a zero divisor and on a result past 64 bits.
+	 */
+	class ActionRegistry
+	{
+	public:
+		using Function = std::function<std::int64_t(const ActionContext&)>;
+
+		ActionRegistry() = default;
+		~ActionRegistry() {}
+
+		void bind(std::uint16_t number, Function function, bool binary = false);
+		void bind(std::uint16_t number, BuiltinAction action);
+		void bindNumber(Function function) { m_number = std::move(function); }
+		void setUser(void* user) { m_user = user; }
+		void* user() const { return m_user; }
+
+		bool bound(std::uint16_t number) const { return number < m_bindings.size() && m_bindings[number].function; }
+		bool binary(std::uint16_t number) const { return number < m_bindings.size() && m_bindings[number].binary; }
+		bool numberBound() const { return static_cast<bool>(m_number); }
+		std::int64_t call(std::uint16_t number, const ActionContext& context) const { return m_bindings[number].function(context); }
+		std::int64_t number(std::int64_t literal) const { return m_number ? m_number({ literal, 0, m_user }) : literal; }
+		std::optional<BuiltinAction> builtin(std::uint16_t number) const
+		{
+			return number < m_bindings.size() ? m_bindings[number].builtin : std::nullopt;
+		}
+		size_t size() const { return m_bindings.size(); }
+
+		static ActionRegistry expression();
+
+	private:
+		struct Binding
+		{
+			Function function;
+			bool binary = false;
+			std::optional<BuiltinAction> builtin;
+		};
+
+		std::vector<Binding> m_bindings;
+		Function m_number;
+		void* m_user = nullptr;
+	};
+}
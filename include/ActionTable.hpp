@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace PL0
+{
+	class Grammar;
+
+	/**
+	 * @brief The `{n}` actions of an L-SDT file, indexed by rule and by position in the right side.
+	 *
+	 * @note An L-SDT line is a rule of the grammar with `{n}` written after some of its symbols,
+	 *       such as "E->T{1}G{2}" or "expression -> term {1} rest {2}". `after(rule, i)` is the
+	 *       action following the i-th symbol of the rule's right side, or `None`; an empty right
+	 *       side ("G->e{7}", "rest -> {7}") has the single position 0. In the compact spelling a
+	 *       position is the character's index after "->", as before.
+	 *       Each rule owns one slot per symbol in a flat array, so a lookup is two loads.
+	 *       A line whose rule is not in the grammar, an unclosed or empty brace, a number outside
+	 *       1..65535, an action before the first symbol or a second action for a position already
+	 *       given one is rejected with UnMatched on reading. Each read starts from an empty table.
+	 */
+	class ActionTable
+	{
+	public:
+		static constexpr std::uint16_t None = 0;
+
+		ActionTable() = default;
+		explicit ActionTable(const Grammar& grammar);
+		~ActionTable() {}
+
+		void read(const Grammar& grammar, std::istream& lsdt);
+		void read(const Grammar& grammar, const std::string& filename);
+
+		std::uint16_t after(int rule, size_t position) const { return m_actions[m_start[rule] + position]; }
+		size_t ruleCount() const { return m_start.empty() ? 0 : m_start.size() - 1; }
+		size_t actionCount() const { return m_count; }
+
+	private:
+		std::vector<std::uint32_t> m_start;    // Per rule, then one past the last: first slot in m_actions.
+		std::vector<std::uint16_t> m_actions;
+		size_t m_count = 0;
+	};
+}
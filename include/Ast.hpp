@@ -0,0 +1,91 @@
+#pragma once
+#include "ActionRegistry.hpp"
+#include "Interner.hpp"
+#include "Optimizer.hpp"
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace PL0
+{
+	using AstIndex = std::int32_t;
+
+	enum class AstOp : std::uint8_t
+	{
+		NUMBER,  // `left` indexes the literal; see Ast::literal.
+		ADD,
+		SUB,
+		MUL,
+		DIV
+	};
+
+	/**
+	 * @brief One expression node; children are indices into the same Ast.
+	 */
+	struct AstNode
+	{
+		AstOp op;
+		AstIndex left;
+		AstIndex right;
+		AstIndex first;  // Lowest index in this node's subtree.
+	};
+
+	/**
+	 * @brief Expression trees laid out in one growing array of nodes.
+	 *
+	 * @note Nodes are only ever appended, and a node is appended after both of its children, so
+	 *       every subtree lies in the run [first, root]; `binary` throws InvalidNode for a child
+	 *       that is not already in the Ast. Evaluation and quadruple generation mark the subtree
+	 *       with one backward pass over that run and then sweep it forwards, skipping nodes of
+	 *       other trees, and printing walks an explicit stack, so none of them recurse however
+	 *       deep the tree is. A root that is not a node evaluates to nothing, prints nothing and
+	 *       lowers to no quadruples. A tree that divides by zero or leaves 64 bits anywhere also
+	 *       evaluates to nothing. Any number of trees can share one Ast; `clear()` drops them all
+	 *       at once and keeps the memory for the next parse.
+	 *       `actions()` turns an expression scheme into one that builds nodes: literals become
+	 *       NUMBER nodes, the built-in ADD, SUB, MUL and DIV actions become the matching nodes and
+	 *       COPY passes node indices along; a scheme with any other action bound throws, as the
+	 *       tree has no node for it. The registry it returns refers to this Ast, which is why an
+	 *       Ast can not be copied. Literals are kept apart from the nodes, so a node stays 16
+	 *       bytes while a literal has the lexer's full 64 bits. The scratch used by the const
+	 *       members makes them unsafe to call from several threads on one Ast.
+	 */
+	class Ast
+	{
+	public:
+		static constexpr AstIndex NoNode = -1;
+
+		Ast() = default;
+		~Ast() {}
+
+		Ast(const Ast&) = delete;
+		Ast& operator=(const Ast&) = delete;
+
+		AstIndex number(std::int64_t value);
+		AstIndex binary(AstOp op, AstIndex left, AstIndex right);
+		const AstNode& operator[](AstIndex index) const { return m_nodes[index]; }
+		std::int64_t literal(const AstNode& node) const { return m_literals[node.left]; }
+		size_t size() const { return m_nodes.size(); }
+		void reserve(size_t nodes) { m_nodes.reserve(nodes); }
+		void clear() { m_nodes.clear(); m_literals.clear(); }
+
+		std::optional<std::int64_t> evaluate(AstIndex root) const;
+		void print(std::ostream& out, AstIndex root) const;
+		SymbolId quadruples(AstIndex root, Interner& names, std::vector<Quadruple>& out) const;
+
+		ActionRegistry actions(const ActionRegistry& scheme);
+
+	private:
+		bool contains(AstIndex index) const { return index >= 0 && static_cast<size_t>(index) < m_nodes.size(); }
+		void mark(AstIndex root) const;
+
+	private:
+		std::vector<AstNode> m_nodes;
+		std::vector<std::int64_t> m_literals;
+		mutable std::vector<std::uint8_t> m_inTree;
+		mutable std::vector<std::int64_t> m_values;
+		mutable std::vector<SymbolId> m_operands;
+		mutable std::vector<std::pair<AstIndex, std::uint8_t>> m_walk;
+	};
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "Lexer.hpp"
+#include "LL1Parser.hpp"
+#include "ThreadPool.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief Recognises many independent inputs against one shared Grammar on a thread pool.
+	 *
+	 * @note One task per worker, and one on the calling thread, claims inputs from a shared
+	 *       counter, so long and short inputs even out across threads. The tasks run through
+	 *       `ThreadPool::forEach`, which makes a batch safe to start from inside a pool task.
+	 *       Each task keeps its parse stack and token buffer for all the inputs it claims, and a
+	 *       lexer only allocates once it reports an error, so after the first few inputs a clean
+	 *       source costs one allocation: its result's message. Reading a file allocates its text
+	 *       as well.
+	 *       Results come back in input order; an input that cannot be read is reported as a
+	 *       failed parse carrying the exception's message.
+	 */
+	class BatchParser
+	{
+	public:
+		BatchParser(std::shared_ptr<const Grammar> grammar, ThreadPool& pool);
+		~BatchParser() {}
+
+		std::vector<ParseResult> parseFiles(const std::vector<std::string>& files);
+		std::vector<ParseResult> parseSources(const std::vector<std::string>& sources);
+
+		static ParseResult parse(const Grammar& grammar, std::string_view source, const TokenBuffer& tokens, std::vector<GrammarSymbol>& stack);
+
+	private:
+		template <typename MakeLexer>
+		std::vector<ParseResult> run(size_t count, MakeLexer makeLexer);
+
+	private:
+		std::shared_ptr<const Grammar> m_grammar;
+		ThreadPool& m_pool;
+	};
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PL0
+{
+	enum class DiagnosticCode : std::uint8_t
+	{
+		INVALID_IDENTIFIER, // A number running into letters, such as "9abc".
+		INVALID_OPERATOR,   // ':' without the '=' of ":=".
+		UNKNOWN_SYMBOL,     // A byte no token starts with.
+		NUMBER_TOO_LARGE    // A literal above INT64_MAX.
+	};
+
+	/**
+	 * @brief A lexer error as a compact record; its message is only built when rendered.
+	 */
+	struct Diagnostic
+	{
+		size_t offset;
+		std::uint32_t line;
+		std::uint32_t length;
+		DiagnosticCode code;
+	};
+
+	/**
+	 * @brief Error records collected during a pass, to be rendered or drained once it is over.
+	 *
+	 * @note At most `limit` records are kept; the rest are only counted by `dropped()`. Nothing is
+	 *       allocated until the first report, so a clean pass costs no memory.
+	 */
+	class Diagnostics
+	{
+	public:
+		static constexpr size_t Unlimited = std::numeric_limits<size_t>::max();
+
+		explicit Diagnostics(size_t limit = Unlimited);
+
+		void report(DiagnosticCode code, size_t line, size_t offset, size_t length)
+		{
+			if (m_records.size() >= m_limit)
+			{
+				m_dropped++;
+				return;
+			}
+			if (m_records.capacity() == 0)
+				reserveFirst();
+			m_records.push_back({ offset, static_cast<std::uint32_t>(line), static_cast<std::uint32_t>(length), code });
+		}
+
+		void append(const Diagnostics& other, size_t shift);
+		std::vector<Diagnostic> drain();
+		void clear();
+		void setLimit(size_t limit) { m_limit = limit; }
+
+		size_t limit() const { return m_limit; }
+		size_t size() const { return m_records.size(); }
+		bool empty() const { return m_records.empty(); }
+		size_t dropped() const { return m_dropped; }
+		const Diagnostic& operator[](size_t i) const { return m_records[i]; }
+
+		void render(std::ostream& out, std::string_view source, size_t base = 0) const;
+		static std::string message(const Diagnostic& diagnostic, std::string_view spelling);
+
+	private:
+		void reserveFirst();
+
+	private:
+		std::vector<Diagnostic> m_records;
+		size_t m_limit;
+		size_t m_dropped = 0;
+	};
+}
@@ -1,6 +1,8 @@
 #pragma once
+#include <cstdint>
 #include <exception>
 #include <string>
+#include <string_view>
 #include <iostream>
 
 namespace PL0
@@ -105,6 +107,80 @@ namespace PL0
 		}
 	};
 
+	class InputTooLarge : public Exception
+	{
+	public:
+		InputTooLarge(const std::string& what)
+		{
+			m_message = "Input too large for " + what;
+		}
+
+	private:
+		virtual const char* what() const noexcept override
+		{
+			return m_message.c_str();
+		}
+	};
+
+	class InvalidEdit : public Exception
+	{
+	public:
+		InvalidEdit(size_t offset, size_t removed, size_t size)
+		{
+			m_message = "Invalid edit: " + std::to_string(removed) + " bytes at offset " + std::to_string(offset)
+				+ " in a source of " + std::to_string(size) + " bytes";
+		}
+
+	private:
+		virtual const char* what() const noexcept override
+		{
+			return m_message.c_str();
+		}
+	};
+
+	class InvalidNode : public Exception
+	{
+	public:
+		InvalidNode(std::int64_t index, size_t size)
+		{
+			m_message = "Invalid node: " + std::to_string(index) + " in a tree of " + std::to_string(size) + " nodes";
+		}
+
+		virtual const char* what() const noexcept override
+		{
+			return m_message.c_str();
+		}
+	};
+
+	class ActionFailed : public Exception
+	{
+	public:
+		ActionFailed(const std::string& reason)
+		{
+			m_message = reason;
+		}
+
+		virtual const char* what() const noexcept override
+		{
+			return m_message.c_str();
+		}
+	};
+
+	class PredictConflict : public Exception
+	{
+	public:
+		PredictConflict(const std::string& first, const std::string& second, std::string_view terminal)
+		{
+			m_message = "Predict conflict: " + first + " and " + second + " both predict " + std::string(terminal);
+		}
+
+	private:
+		virtual const char* what() const noexcept override
+		{
+			return m_message.c_str();
+		}
+	};
+
 	class UnMatched : public Exception
 	{
 	public:
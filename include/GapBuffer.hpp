@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief Editable text kept as one array with a movable hole in it.
+	 *
+	 * @note The text is [0, gap start) followed by [gap end, capacity). An edit moves the gap to
+	 *       its offset and writes into it, so it costs the size of the edit plus the distance from
+	 *       the previous edit, not the size of the text. `tail(offset)` moves the gap to `offset`
+	 *       to hand out everything after it as one view, valid until the next edit or move.
+	 */
+	class GapBuffer
+	{
+	public:
+		GapBuffer() = default;
+		explicit GapBuffer(std::string_view text);
+		~GapBuffer() {}
+
+		size_t size() const { return m_buffer.size() - (m_gapEnd - m_gapStart); }
+		char operator[](size_t i) const { return i < m_gapStart ? m_buffer[i] : m_buffer[i + m_gapEnd - m_gapStart]; }
+
+		void replace(size_t offset, size_t removed, std::string_view inserted);
+		std::string_view tail(size_t offset);
+		std::string substr(size_t offset, size_t length) const;
+		std::string str() const { return substr(0, size()); }
+
+	private:
+		void moveGap(size_t offset);
+
+	private:
+		static constexpr size_t MinGap = 4096;
+
+		std::vector<char> m_buffer;
+		size_t m_gapStart = 0;
+		size_t m_gapEnd = 0;
+	};
+}
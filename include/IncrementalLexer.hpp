@@ -0,0 +1,107 @@
+#pragma once
+#include "Diagnostics.hpp"
+#include "GapBuffer.hpp"
+#include "Lexer.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief Running sums over a sequence of counts (a Fenwick tree).
+	 */
+	class PrefixSums
+	{
+	public:
+		void assign(const std::vector<size_t>& values);
+		void add(size_t i, std::ptrdiff_t delta);
+		size_t before(size_t i) const;   // Sum of [0, i).
+		size_t find(size_t value) const; // Largest i with before(i) <= value, skipping zero counts.
+		size_t size() const { return m_tree.size() - 1; }
+
+	private:
+		std::vector<size_t> m_tree{ 0 };
+	};
+
+	/**
+	 * @brief A run of consecutive tokens, positioned relative to the first of them.
+	 *
+	 * @note A chunk starts at its first token (the first chunk at offset 0) and covers the text up
+	 *       to the next chunk, trailing blanks and comments included. Offsets of its tokens and of
+	 *       its errors are from the chunk start, and error lines from the chunk's first line, so
+	 *       an edit elsewhere leaves the chunk untouched.
+	 */
+	struct TokenChunk
+	{
+		size_t bytes = 0;
+		size_t newlines = 0;
+		TokenBuffer tokens;
+		std::vector<Diagnostic> diagnostics;
+	};
+
+	/**
+	 * @brief Chunks [first, first + removed) were replaced by [first, first + inserted).
+	 *
+	 * @note Chunk `first - 1`, and chunk `first` if `inserted` is not 0, start where they did and
+	 *       have the same tokens before them. With no chunk inserted, chunk `first - 1` took
+	 *       over the replaced text and its tokens are unchanged.
+	 */
+	struct ChunkEdit
+	{
+		size_t first;
+		size_t removed;
+		size_t inserted;
+		std::ptrdiff_t tokenDelta;
+	};
+
+	/**
+	 * @brief Keeps the tokens of an editable source up to date, re-lexing only around each edit.
+	 *
+	 * @note The text is a GapBuffer and the tokens are TokenChunks of about `ChunkTokens` tokens,
+	 *       with running sums of their sizes, line counts and token counts. An edit re-lexes from
+	 *       the start of the chunk it falls in and stops at the first old chunk boundary past it
+	 *       where a new token starts again, so its cost is the edit plus a chunk or two, plus the
+	 *       distance the gap moves. Only when the number of chunks changes are the sums rebuilt.
+	 *       Identifiers are not interned; their values are 0, as in a Lexer without an Interner.
+	 */
+	class IncrementalLexer
+	{
+	public:
+		static constexpr size_t ChunkTokens = 256;
+
+		explicit IncrementalLexer(const std::string& filename);
+		explicit IncrementalLexer(std::string_view text);
+		~IncrementalLexer() {}
+
+		ChunkEdit edit(const TextEdit& edit);
+
+		size_t size() const { return m_text.size(); }
+		std::string text() const { return m_text.str(); }
+		std::string text(size_t offset, size_t length) const { return m_text.substr(offset, length); }
+		size_t chunkCount() const { return m_chunks.size(); }
+		const TokenChunk& chunk(size_t k) const { return m_chunks[k]; }
+		size_t chunkStart(size_t k) const { return m_bytes.before(k); }
+		size_t firstToken(size_t k) const { return m_tokenCounts.before(k); }
+		size_t tokenCount() const { return m_tokenCounts.before(m_chunks.size()); }
+		TokenView token(size_t index) const;
+		TokenBuffer tokens() const;
+		std::vector<Diagnostic> diagnostics() const;
+		void printDiagnostics(std::ostream& out = std::cout) const;
+
+	private:
+		void build(std::string_view text);
+		std::vector<TokenChunk> split(std::string_view region, size_t firstLine, const TokenBuffer& tokens,
+			std::vector<Diagnostic> diagnostics, size_t count) const;
+		void reindex();
+
+	private:
+		GapBuffer m_text;
+		std::vector<TokenChunk> m_chunks;
+		PrefixSums m_bytes;
+		PrefixSums m_newlines;
+		PrefixSums m_tokenCounts;
+	};
+}
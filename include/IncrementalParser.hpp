@@ -0,0 +1,38 @@
+#pragma once
+#include "IncrementalLexer.hpp"
+#include "LL1Parser.hpp"
+#include <string>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief LL(1) recogniser that keeps a source, its tokens and its parse up to date across edits.
+	 *
+	 * @note The parse stack is saved where each token chunk of the IncrementalLexer starts. After
+	 *       an edit the parse resumes from the checkpoint of the first re-lexed chunk. It stops at
+	 *       the first later checkpoint whose stack matches the previous parse, reusing that outcome.
+	 *       Chunks past the furthest one the parse reached hold no valid checkpoint.
+	 *       Steps go through `Grammar::step`, as in LL1Parser and BatchParser.
+	 */
+	class IncrementalParser
+	{
+	public:
+		IncrementalParser(const std::string& filename, const std::string& rules);
+		~IncrementalParser() {}
+
+		const ParseResult& parse();
+		const ParseResult& edit(const TextEdit& edit);
+		const IncrementalLexer& lexer() const { return m_lexer; }
+
+	private:
+		void run(size_t chunk, size_t convergeFrom, size_t oldReached, ParseResult outcome);
+
+	private:
+		IncrementalLexer m_lexer;
+		Grammar m_grammar;
+		std::vector<std::vector<GrammarSymbol>> m_checkpoints;  // Per chunk: the stack before its first token.
+		size_t m_reached = 0;                                   // Last chunk whose checkpoint is valid.
+		ParseResult m_result;
+	};
+}
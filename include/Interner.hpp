@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief Dense id of an interned string; ids are handed out from 0 in first-seen order.
+	 */
+	using SymbolId = std::uint32_t;
+
+	/**
+	 * @brief Stores every distinct string once and maps it to a SymbolId shared across the pipeline.
+	 *
+	 * @note Id 0 is always the empty string. Views from `name()` stay valid as long as the interner.
+	 *       Not thread-safe; intern from one thread at a time.
+	 */
+	class Interner
+	{
+	public:
+		static constexpr SymbolId Empty = 0;
+
+		Interner();
+		~Interner() {}
+
+		Interner(const Interner&) = delete;
+		Interner& operator=(const Interner&) = delete;
+
+		SymbolId intern(std::string_view str);
+		std::optional<SymbolId> find(std::string_view str) const;
+		std::string_view name(SymbolId id) const { return m_names[id]; }
+		size_t size() const { return m_names.size(); }
+
+	private:
+		static std::uint64_t hash(std::string_view str);
+		size_t probe(std::string_view str, std::uint64_t hash) const;
+		std::string_view store(std::string_view str);
+		void rehash();
+
+	private:
+		static constexpr SymbolId NoSymbol = ~SymbolId(0);
+		static constexpr size_t BlockSize = 1 << 16;
+
+		std::vector<std::string_view> m_names;
+		std::vector<std::uint64_t> m_hashes;
+		std::vector<SymbolId> m_slots;      // Open addressing with linear probing; size is a power of two.
+		std::vector<std::unique_ptr<char[]>> m_blocks;
+		size_t m_blockUsed = BlockSize;
+	};
+}
@@ -1,82 +1,324 @@
 #pragma once
-#include "PL0.hpp"
-#include <deque>
-#include <set>
-#include <map>
+#include "ActionRegistry.hpp"
+#include "ActionTable.hpp"
+#include "Ast.hpp"
+#include "Lexer.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
 #include <iomanip>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
 #include <sstream>
+#include <vector>
 
 namespace PL0
 {
-	struct Element {
-		std::string type; 
-		int value;
+	enum class SemanticKind : std::uint8_t
+	{
+		TERMINAL,     // `id` is a grammar symbol still to be matched.
+		NONTERMINAL,  // `id` is a grammar symbol still to be expanded.
+		SYNTHESIZED,  // Slot for the synthesized value of nonterminal `id`.
+		ACTION        // `id` is the number of an L-SDT action.
+	};
+
+	/**
+	 * @brief One entry of the semantic stack: a tag, a small id and the value carried with it.
+	 */
+	struct SemanticEntry
+	{
+		SemanticKind kind;
 		bool hasValue = false;
-		Element(const std::string& str):type(str),value(0){}
-		Element(const std::string& str,int val):type(str),value(val){}
+		std::uint16_t id = 0;
+		std::int64_t value = 0;
+
+		bool is(SemanticKind other, std::uint16_t otherId) const { return kind == other && id == otherId; }
 	};
 
 	struct Symbol {
 		char sign;
-		int value;
+		std::int64_t value;
 	};
 
+	/**
+	 * @brief Grammar terminal of a token kind in the expression grammars; '?' for kinds they lack.
+	 */
+	constexpr char terminalOf(TokenKind kind)
+	{
+		switch (kind)
+		{
+		case TokenKind::IDENT: return 'i';
+		case TokenKind::NUMBER: return 'n';
+		case TokenKind::PLUS: return '+';
+		case TokenKind::MINUS: return '-';
+		case TokenKind::TIMES: return '*';
+		case TokenKind::SLASH: return '/';
+		case TokenKind::LPAREN: return '(';
+		case TokenKind::RPAREN: return ')';
+		case TokenKind::ENDOFFILE: return '#';
+		default: return '?';
+		}
+	}
+
+	/**
+	 * @brief Outcome of an LL(1) parse; `errorToken` is the index of the offending token.
+	 */
+	struct ParseResult
+	{
+		bool accepted = false;
+		size_t errorToken = 0;
+		std::string message;
+	};
+
+	using GrammarSymbol = std::uint16_t;
+
+	/**
+	 * @brief What one step of the LL(1) recogniser did; see `Grammar::step`.
+	 */
+	enum class ParseStep : std::uint8_t
+	{
+		MATCH,          // The terminal on top was the lookahead and has been popped.
+		EXPAND,         // The nonterminal on top was replaced by the right side of the predicted rule.
+		ACCEPT,         // Only '#' is left and so is the input.
+		EXTRA_INPUT,    // Only '#' is left but the input is not.
+		NO_PRODUCTION,  // No rule for the nonterminal on top and the lookahead.
+		NOT_FOUND       // A terminal on top that is not the lookahead.
+	};
+
+	/**
+	 * @brief Set of grammar symbol ids, sized to the grammar it belongs to.
+	 */
+	class SymbolSet
+	{
+	public:
+		SymbolSet() = default;
+		explicit SymbolSet(size_t symbols) : m_words((symbols + 63) / 64, 0) {}
+
+		bool operator[](size_t symbol) const { return symbol / 64 < m_words.size() && (m_words[symbol / 64] >> (symbol % 64) & 1); }
+		void set(size_t symbol) { m_words[symbol / 64] |= std::uint64_t(1) << (symbol % 64); }
+		void reset() { std::fill(m_words.begin(), m_words.end(), 0); }
+		SymbolSet& operator|=(const SymbolSet& other) { merge(other); return *this; }
+		bool operator==(const SymbolSet& other) const = default;
+
+		// Adds every member of `other`; returns whether this set grew.
+		bool merge(const SymbolSet& other)
+		{
+			std::uint64_t grew = 0;
+			for (size_t i = 0; i < m_words.size(); i++)
+			{
+				grew |= other.m_words[i] & ~m_words[i];
+				m_words[i] |= other.m_words[i];
+			}
+			return grew != 0;
+		}
+
+		template <typename Function>
+		void forEach(Function function) const
+		{
+			for (size_t i = 0; i < m_words.size(); i++)
+				for (std::uint64_t word = m_words[i]; word != 0; word &= word - 1)
+					function(i * 64 + std::countr_zero(word));
+		}
+
+		std::vector<std::uint64_t>& words() { return m_words; }
+		const std::vector<std::uint64_t>& words() const { return m_words; }
+
+	private:
+		std::vector<std::uint64_t> m_words;
+	};
+
+	/**
+	 * @brief Predict table slot: the rule for the row that owns it, or `NoSymbol` if none does.
+	 */
+	struct PredictEntry
+	{
+		GrammarSymbol owner;
+		std::int16_t rule;
+	};
+
+	/**
+	 * @brief An LL(1) grammar with its predict table.
+	 *
+	 * @note Rules come in two spellings. Written without spaces ("E->TG") every character is a
+	 *       symbol, uppercase letters are nonterminals and 'e' is epsilon. Written with spaces
+	 *       ("expression -> term expression_tail") symbols are names, the nonterminals are the names
+	 *       on a left side, an empty right side is epsilon, and a terminal named after a token kind
+	 *       ("ident", "plus", "beginsym", ...) matches tokens of that kind.
+	 *       Symbols get dense ids: nonterminals first in `m_Vn` order, then the terminals and '#'.
+	 *       The predict table is row-displaced: each nonterminal's row is laid over one shared array
+	 *       at an offset where its entries land in free slots, and a slot remembers which row owns it.
+	 *       A lookup is one load and one compare, and the array grows with the number of entries
+	 *       rather than nonterminals times symbols.
+	 *       Right-hand sides are stored as id arrays, reversed and without epsilon, ready to be pushed.
+	 *       FIRST, FOLLOW and nullable are bitsets over the ids, solved by worklists that only revisit
+	 *       the nonterminals fed by a set that just grew.
+	 *       Built from a rules file of at least `CacheMinRules` rules, the tables are saved next to it in
+	 *       `<rules>.cache`, keyed by a hash of the rules text; later runs load that file instead.
+	 *       Nothing changes after construction, so one `std::shared_ptr<const Grammar>` can serve any
+	 *       number of parsers on any number of threads.
+	 */
 	class Grammar
 	{
 	public:
+		static constexpr GrammarSymbol NoSymbol = 0xFFFF;
+		static constexpr std::int16_t NoProduction = -1;
+		static constexpr const char* CacheSuffix = ".cache";
+		static constexpr size_t CacheMinRules = 64;
+
 		Grammar(const std::string& rules);
+		explicit Grammar(std::vector<std::string> rules);
 		~Grammar() {};
+		void build();
+		bool loadCache(const std::string& path, std::string_view rulesText);
+		void saveCache(const std::string& path, std::string_view rulesText) const;
+		void calNullable();
 		void calFirstSet();
 		void calFollowSet();
 		void calPredictTable();
+		void encodeSymbols();
+		void indexSymbols();
 		bool contain(const std::vector<char>& vec, char c);
-		void printRules();
-		void printVn();
-		void printVt();
-		void printFirstSet();
-		void printFollowSet();
-		void printPredictTable();
+		bool named() const { return m_named; }
+		GrammarSymbol symbolOf(char c) const { return m_symbolId[static_cast<unsigned char>(c)]; }
+		GrammarSymbol symbolOf(std::string_view name) const;
+		GrammarSymbol symbolOf(TokenKind kind) const { return m_kindSymbol[static_cast<size_t>(kind)]; }
+		std::string_view spelling(GrammarSymbol symbol) const { return symbol < m_symbols.size() ? std::string_view(m_symbols[symbol]) : "?"; }
+		bool isNonterminal(GrammarSymbol symbol) const { return symbol < m_Vn.size(); }
+		int predict(GrammarSymbol nonterminal, GrammarSymbol terminal) const
+		{
+			size_t slot = static_cast<size_t>(std::ptrdiff_t(m_base[nonterminal]) + terminal);
+			return slot < m_entries.size() && m_entries[slot].owner == nonterminal ? m_entries[slot].rule : NoProduction;
+		}
+		std::span<const GrammarSymbol> pushSymbols(int rule) const { return { m_rhs.data() + m_rhsStart[rule], m_rhs.data() + m_rhsStart[rule + 1] }; }
+
+		// One predict/push step on `stack`, shared by every recogniser; `rule` is set on EXPAND.
+		// Failures leave the stack as it was.
+		ParseStep step(std::vector<GrammarSymbol>& stack, GrammarSymbol lookahead, int& rule) const
+		{
+			GrammarSymbol top = stack.back();
+			if (top == m_endMarker)
+				return lookahead == m_endMarker ? ParseStep::ACCEPT : ParseStep::EXTRA_INPUT;
+			if (top == lookahead)
+			{
+				stack.pop_back();
+				return ParseStep::MATCH;
+			}
+			if (!isNonterminal(top))
+				return ParseStep::NOT_FOUND;
+			rule = predict(top, lookahead);
+			if (rule == NoProduction)
+				return ParseStep::NO_PRODUCTION;
+
+			stack.pop_back();
+			// Element-wise: the range insert of 16-bit symbols measured slower on these short productions.
+			for (GrammarSymbol symbol : pushSymbols(rule))
+				stack.push_back(symbol);
+			return ParseStep::EXPAND;
+		}
+		std::string describe(ParseStep step, GrammarSymbol top, std::string_view lookahead) const;  // `lookahead` is its text, "#" at the end.
+		std::string_view rightSide(int rule) const;
+		int ruleOf(std::string_view rule) const;
+		size_t symbolCount(std::string_view rule) const;
+		void printRules() const;
+		void printVn() const;
+		void printVt() const;
+		void printFirstSet() const;
+		void printFollowSet() const;
+		void printPredictTable() const;
+		void printSets(const char* name, const std::vector<SymbolSet>& sets, bool withEpsilon) const;
 	public:
 		std::vector<std::string> m_Rules;
-		std::vector<char> m_Vn;
-		std::vector<char> m_Vt;
-		std::map<char, std::set<char>> m_First;
-		std::map<char, std::set<char>> m_Follow;
-		std::map<std::pair<char, char>, std::string> m_PredictTable;
-		std::map<std::pair<char, char>, int> m_RuleRowTable;
+		bool m_named = false;
+		std::vector<std::string> m_Vn;
+		std::vector<std::string> m_Vt;
+		std::vector<SymbolSet> m_First;           // Per nonterminal id; epsilon is kept in m_nullable.
+		std::vector<SymbolSet> m_Follow;
+		SymbolSet m_nullable;
+		std::vector<std::string> m_symbols;       // Spelling of each id.
+		std::map<std::string, GrammarSymbol, std::less<>> m_symbolNames;
+		std::array<GrammarSymbol, 256> m_symbolId;                                      // Single-character names.
+		std::array<GrammarSymbol, static_cast<size_t>(TokenKind::COUNT)> m_kindSymbol;  // Terminal matching each token kind.
+		GrammarSymbol m_endMarker;                // Id of '#'.
+		std::vector<std::int32_t> m_base;         // Per nonterminal: where its row starts in m_entries.
+		std::vector<PredictEntry> m_entries;      // [m_base[nonterminal] + symbol] -> rule, if owned by nonterminal.
+		std::vector<GrammarSymbol> m_ruleLeft;
+		std::vector<GrammarSymbol> m_rhs;
+		std::vector<std::uint32_t> m_rhsStart;    // Rule i pushes m_rhs[m_rhsStart[i], m_rhsStart[i + 1]).
 	};
 
+	/**
+	 * @brief Table-driven LL(1) parser reading its tokens straight from a Lexer or a TokenBuffer.
+	 *
+	 * @note Tokens are consumed with one token of lookahead, so a Lexer is driven on demand and the
+	 *       front end is a single pass. NUMBER tokens carry the value the lexer already decoded.
+	 *       Steps are reported through `m_trace`; by default they are only kept in its ring
+	 *       buffer and printed when the parse fails.
+	 *       A parser is one parsing session over a read-only Grammar. Built from a rules file it has
+	 *       a Grammar of its own; built from a shared one it only adds its stacks.
+	 *       `semanticParse` runs the L-SDT scheme through `m_registry` and prints the result;
+	 *       `buildAst` runs the same scheme into an Ast instead and returns the root, or
+	 *       `Ast::NoNode` if the input is rejected.
+	 */
 	class LL1Parser
 	{
 	public:
-		LL1Parser(const std::string& filename,const std::string& rules);
+		explicit LL1Parser(const std::string& rules);
+		explicit LL1Parser(std::shared_ptr<const Grammar> grammar);
+		LL1Parser(Lexer& lexer, const std::string& rules);
 		~LL1Parser();
 		bool parse();
+		bool parse(Lexer& lexer);
+		bool parse(const Lexer& lexer, const TokenBuffer& tokens);
 		void semanticParse();
-		std::string getFileLine(int line);
-		std::string getSign(int line);
-		std::string getCode(int line);
-		Symbol switchCode(std::string sign);
-		Element switchCode(std::string sign,bool a);
-		void getOriginFile(std::string filename);
+		void semanticParse(Lexer& lexer);
+		void semanticParse(const Lexer& lexer, const TokenBuffer& tokens);
+		AstIndex buildAst(Ast& ast);
+		AstIndex buildAst(Lexer& lexer, Ast& ast);
+		AstIndex buildAst(const Lexer& lexer, const TokenBuffer& tokens, Ast& ast);
+		bool translate(std::int64_t& result);
+		void attach(Lexer& lexer);
+		void attach(const Lexer& lexer, const TokenBuffer& tokens);
+		void advance();
+		bool atEnd() const { return m_lookahead.kind == TokenKind::ENDOFFILE; }
+		Symbol currentSymbol() const;
+		std::string lookaheadText() const;
+		void printErrorPosition();
 		void getL_sdtFile(std::string filename);
-		int getActionNumber(char left, std::string right, char Nonterminal);
 		void printStack();
 		void printExternStack();
 		void actionFunction(int actionindex);
 
+		void trace(TraceEvent event, GrammarSymbol symbol, std::int32_t detail, size_t depth)
+		{
+			if (!m_trace.enabled(TraceLevel::ERRORS))
+				return;
+			m_trace.record({ static_cast<std::uint32_t>(m_lookahead.offset), static_cast<std::uint32_t>(m_lookahead.length),
+				static_cast<std::uint32_t>(depth), detail, symbol, event });
+			if (m_trace.level() == TraceLevel::STEPS)
+				traceLatest();
+		}
+		void traceLatest();
+		void traceFailure();
+
 	public:
-		std::string PL0;
-		std::string m_file;
-		std::stringstream l_sdt;
-		std::string m_currentChar;
-		int m_currentLine;
-		int totalLines;
-		std::deque<char> m_stack;
-		std::deque<Element> m_externStack;
-		Grammar m_grammar;
-
-		mutable int m_valueCache = 0;
+		TokenView m_lookahead{ TokenType::ENDOFFILE, TokenKind::ENDOFFILE, 0, 0 };
+		Lexer* m_stream = nullptr;              // Pulled for tokens when no buffer is attached.
+		const Lexer* m_source = nullptr;        // Owns the text the tokens point into.
+		const TokenBuffer* m_tokens = nullptr;
+		size_t m_nextToken = 0;
+		std::vector<GrammarSymbol> m_stack;
+		std::vector<SemanticEntry> m_externStack;
+		std::shared_ptr<const Grammar> m_tables;
+		const Grammar& m_grammar;               // *m_tables
+		Tracer m_trace;
+		ActionTable m_actions;                  // From getL_sdtFile; empty of actions until then.
+		ActionRegistry m_registry = ActionRegistry::expression();
+
+		std::optional<std::int64_t> m_operand;  // Handed from a synthesized slot to the binary action above it.
 	};
 }
 
@@ -1,13 +1,21 @@
 #pragma once
-#include "PL0.hpp"
+#include "Exceptions.hpp"
+#include "PreDefined.hpp"
+#include "MappedFile.hpp"
+#include "Scan.hpp"
+#include "ThreadPool.hpp"
+#include "Interner.hpp"
+#include "Diagnostics.hpp"
 #include <iostream>
 #include <format>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
-#include <queue>
+#include <vector>
+#include <limits>
 
 namespace PL0
 {
@@ -22,44 +30,178 @@ namespace PL0
 		ENDOFFILE
 	};
 
+	enum class InputMode
+	{
+		BUFFERED,   // Read the whole file into memory.
+		MAPPED      // Map the file read-only; tokens point into the mapping.
+	};
+
+	/**
+	 * @brief In-memory source text for a Lexer that does not own its input.
+	 *
+	 * @note `text` must outlive the lexer. `firstLine` is the line number reported for its first line.
+	 */
+	struct SourceText
+	{
+		std::string_view text;
+		size_t firstLine = 1;
+	};
+
+	/**
+	 * @brief Replace the `removed` bytes at `offset` with `inserted`.
+	 */
+	struct TextEdit
+	{
+		size_t offset;
+		size_t removed;
+		std::string inserted;
+	};
+
 	struct Token
 	{
 		TokenType type;
+		TokenKind kind;
 		std::string value;
+		std::int64_t number = 0;   // Decoded literal of a NUMBER token.
+	};
+
+	/**
+	 * @brief A token as a (kind, offset, length) triple into the lexer's source.
+	 *
+	 * @note Use `Lexer::text()` to get the spelling; it stays valid as long as the lexer.
+	 *       `number` is the literal of a NUMBER token, decoded while it was scanned.
+	 */
+	struct TokenView
+	{
+		TokenType type;
+		TokenKind kind;
+		size_t offset;
+		size_t length;
+		std::int64_t number = 0;
+	};
+
+	constexpr TokenType tokenTypeOf(TokenKind kind)
+	{
+		if (isKeyWordKind(kind))
+			return TokenType::KEYWORD;
+		if (isOperatorKind(kind))
+			return TokenType::OPERATOR;
+		if (isDelimiterKind(kind))
+			return TokenType::DELIMITER;
+		switch (kind)
+		{
+		case TokenKind::IDENT: return TokenType::IDENTIFIER;
+		case TokenKind::NUMBER: return TokenType::NUMBER;
+		case TokenKind::ENDOFFILE: return TokenType::ENDOFFILE;
+		default: return TokenType::NONE;
+		}
+	}
+
+	/**
+	 * @brief Tokens stored column-wise (struct of arrays) for batch consumers.
+	 *
+	 * @note Offsets and lengths are 32-bit, so a buffer covers sources below 4 GiB.
+	 *       `values` holds the decoded literal of NUMBER tokens, the SymbolId of IDENT tokens when
+	 *       the lexer has an Interner, and 0 otherwise.
+	 *       End of file is not stored; the buffer simply ends.
+	 */
+	struct TokenBuffer
+	{
+		std::vector<TokenKind> kinds;
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> lengths;
+		std::vector<std::int64_t> values;
+
+		size_t size() const { return kinds.size(); }
+		bool empty() const { return kinds.empty(); }
+
+		TokenView operator[](size_t i) const
+		{
+			return { tokenTypeOf(kinds[i]), kinds[i], offsets[i], lengths[i], kinds[i] == TokenKind::NUMBER ? values[i] : 0 };
+		}
+
+		void push_back(const TokenView& token, std::int64_t value)
+		{
+			kinds.push_back(token.kind);
+			offsets.push_back(static_cast<std::uint32_t>(token.offset));
+			lengths.push_back(static_cast<std::uint32_t>(token.length));
+			values.push_back(value);
+		}
+
+		void reserve(size_t count)
+		{
+			kinds.reserve(count);
+			offsets.reserve(count);
+			lengths.reserve(count);
+			values.reserve(count);
+		}
+
+		void clear()
+		{
+			kinds.clear();
+			offsets.clear();
+			lengths.clear();
+			values.clear();
+		}
 	};
 
 	class Lexer
 	{
 	public:
-		explicit Lexer(const std::string& filename);
+		explicit Lexer(const std::string& filename, InputMode mode = InputMode::BUFFERED);
+		explicit Lexer(SourceText source);
 		~Lexer();
 
-		bool isKeyWords(std::string str);
-		bool isOperatorWords(std::string str);
-		bool isDelimiterWords(std::string str);
+		// m_source may point into m_file, and moving a short string moves its characters too.
+		Lexer(const Lexer&) = delete;
+		Lexer& operator=(const Lexer&) = delete;
+		Lexer(Lexer&& other) noexcept;
+		Lexer& operator=(Lexer&& other) noexcept;
+
+		bool isKeyWords(std::string_view str);
+		bool isOperatorWords(std::string_view str);
+		bool isDelimiterWords(std::string_view str);
 		bool isIdentifier(std::string str);
 		Token nextToken();
-		std::string showfile() { return m_file; }
+		TokenView nextTokenView();
+		size_t nextTokens(TokenBuffer& buffer, size_t maxCount);
+		TokenBuffer tokenizeAll();
+		TokenBuffer tokenizeParallel(ThreadPool& pool);
+		Diagnostics& diagnostics() { return m_diagnostics; }
+		void printDiagnostics(std::ostream& out = std::cout);
+		void setInterner(Interner& names) { m_interner = &names; }
+		std::string_view text(const TokenView& token) const { return m_source.substr(token.offset, token.length); }
+		std::string_view source() const { return m_source; }
+		std::string value(const TokenView& token) const;
+		std::string showfile() { return std::string(m_source); }
 		char showCurrentChar() { return m_currentChar; }
+		size_t currentLine() const { return m_line; }
 		char getNextChar(size_t line, size_t column);
 
 	private:
 		void nextChar();
+		void advanceTo(size_t pos, size_t newlines);
+		std::int64_t tokenValue(const TokenView& token);
 		char getChar(size_t line, size_t column);
+		void buildLineStarts();
 		void skipComment();
 		void skipSpace();
-		Token parseNumber();
-		Token parseKeyWordOrIdentifier();
-		Token parseOperator();
-		Token parseDelimiter();
-		Token parseEOF();
-		Token parseUnknownSymbol();
+		TokenView parseNumber();
+		TokenView parseKeyWordOrIdentifier();
+		TokenView parseSymbol();
+		TokenView parseEOF();
+		TokenView parseUnknownSymbol();
 
 	private:
 		std::string m_file;
+		MappedFile m_mapping;
+		std::string_view m_source;
+		std::vector<size_t> m_lineStarts;
 		char m_currentChar;
+		size_t m_pos;
 		size_t m_line;
 		size_t m_column;
-		std::queue<std::string> m_errors;
+		Interner* m_interner = nullptr;
+		Diagnostics m_diagnostics;
 	};
-}
\ No newline at end of file
+}
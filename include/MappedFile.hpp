@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace PL0
+{
+	/**
+	 * @brief A read-only memory mapping of a whole file.
+	 *
+	 * @note The mapping lives as long as the object; views handed out by `view()`
+	 *       must not outlive it. An empty file yields an empty view.
+	 */
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string& filename);
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		const char* data() const { return m_data; }
+		size_t size() const { return m_size; }
+		std::string_view view() const { return { m_data, m_size }; }
+
+	private:
+		void release();
+
+	private:
+		const char* m_data = nullptr;
+		size_t m_size = 0;
+#ifdef _WIN32
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#endif
+	};
+}
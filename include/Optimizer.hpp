@@ -1,11 +1,12 @@
 #pragma once
+#include "Interner.hpp"
 #include <memory>
-#include <unordered_map>
 #include <vector>
 #include <charconv>
 #include <concepts>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <exception>
 
 namespace PL0
@@ -46,26 +47,28 @@ namespace PL0
         return result;
     }
 
+    /**
+     * @brief A quadruple whose fields are interned; an absent `arg2` is `Interner::Empty`.
+     */
     class Quadruple
     {
     public:
         Quadruple() = default;
-        Quadruple(const std::string& _op, const std::string& _arg1, const std::string& _arg2,
-            const std::string& _result)
+        Quadruple(SymbolId _op, SymbolId _arg1, SymbolId _arg2, SymbolId _result)
             : op(_op), arg1(_arg1), arg2(_arg2), result(_result)
         {
         }
 
     public:
-        std::string op;
-        std::string arg1;
-        std::string arg2;
-        std::string result;
+        SymbolId op = Interner::Empty;
+        SymbolId arg1 = Interner::Empty;
+        SymbolId arg2 = Interner::Empty;
+        SymbolId result = Interner::Empty;
     };
 
     template <typename T>
         requires std::integral<T> || std::floating_point<T>
-    std::optional<T> string_to_number(const std::string & str)
+    std::optional<T> string_to_number(std::string_view str)
     {
         T value = 0;
         auto result = std::from_chars(str.data(), str.data() + str.size(), value);
@@ -98,8 +101,8 @@ namespace PL0
         }
 
     public:
-        std::vector<std::string> varNames;  // Variables that map to this node.
-        std::string value;  // The value of this node; Can be var name, constant or operator.
+        std::vector<SymbolId> varNames;  // Variables that map to this node.
+        SymbolId value;  // The value of this node; Can be var name, constant or operator.
         std::vector<NodePtr> children;  // Children of this node.
         Type type;                      // Type of this node; Can be Type::VAR or Type::CONST.
     };
@@ -114,7 +117,7 @@ namespace PL0
         using NodePtr = std::shared_ptr<Node>;
 
     public:
-        explicit Optimizer() = default;
+        explicit Optimizer(Interner& names) : m_names(names) {}
 
         void buildDAG(std::vector<Quadruple>& quads);
 
@@ -122,16 +125,18 @@ namespace PL0
 
     private:
         template <typename T>
-        bool isConstant(const std::string& str)
+        bool isConstant(SymbolId id)
         {
-            return string_to_number<T>(str).has_value();
+            return string_to_number<T>(m_names.name(id)).has_value();
         }
 
     private:
         template <typename T>
-        T calculate(const std::string& op, const std::string& arg1, const std::string& arg2)
+        T calculate(SymbolId opId, SymbolId arg1, SymbolId arg2)
         {
-            std::optional<T> realArg1 = string_to_number<T>(arg1), realArg2 = string_to_number<T>(arg2);
+            std::string_view op = m_names.name(opId);
+            std::optional<T> realArg1 = string_to_number<T>(m_names.name(arg1)),
+                realArg2 = string_to_number<T>(m_names.name(arg2));
             if (!realArg1.has_value() || !realArg2.has_value()) {
                 throw "Invalid argument for calculation.";
             }
@@ -157,7 +162,7 @@ namespace PL0
          *
          * @note 1 var name maps to 1 node; 1 node containes 1 or more var names.
          */
-        bool isNodeExists(std::string varName);
+        bool isNodeExists(SymbolId varName);
 
         /**
          * @brief Map a variable name to a node in the DAG. If the map already exists, then update it.
@@ -166,14 +171,23 @@ namespace PL0
          *       By calling this function, the map from `x` to `nodeN` is created, and
          *       `isNodeExists(x)` would become true.
          */
-        void mapVarNameToNode(std::string x, NodePtr nodeN);
+        void mapVarNameToNode(SymbolId x, NodePtr nodeN);
+
+        /**
+         * @brief The node `x` maps to, or a null pointer if there is none.
+         *
+         * @note Symbol ids are dense, so the map is a table indexed by id that grows on demand.
+         */
+        NodePtr& nodeOf(SymbolId x);
 
     private:
+        Interner& m_names;
+
         // A vector of all nodes in the DAG.
         std::vector<NodePtr> m_nodes;
 
-        // A hash map mapping variable names to their corresponding nodes.
-        std::unordered_map<std::string, NodePtr> m_varName2nodePtr;
+        // A table indexed by variable name id, mapping names to their corresponding nodes.
+        std::vector<NodePtr> m_varName2nodePtr;
     };
 
 }  // namespace PL0
\ No newline at end of file
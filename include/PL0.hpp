@@ -1,6 +1,13 @@
 #pragma once
 #include "Exceptions.hpp"
 #include "PreDefined.hpp"
+#include "MappedFile.hpp"
+#include "Scan.hpp"
+#include "ThreadPool.hpp"
+#include "Interner.hpp"
+#include "Diagnostics.hpp"
 #include "Lexer.hpp"
+#include "Ast.hpp"
 #include "LL1Parser.hpp"
+#include "BatchParser.hpp"
 #include "Optimizer.hpp"
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+#include "LL1Parser.hpp"
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief Emits a recursive-descent parser in C++ for the grammar in a rules.txt file.
+	 *
+	 * @note Each nonterminal becomes a function that switches on the lookahead terminal, with the
+	 *       cases taken from Grammar's predict table, so the generated parser accepts and rejects
+	 *       exactly like the table-driven one. Given an L-SDT file, the `{n}` actions are inlined
+	 *       from the code registered with `setAction()`. That code uses `$$` for the value being
+	 *       built (it starts as the inherited value) and `$1` for the value of the symbol just
+	 *       before the action. Without an L-SDT file the parser only recognises.
+	 */
+	class ParserGenerator
+	{
+	public:
+		explicit ParserGenerator(const std::string& rules, const std::string& lsdt = "");
+		~ParserGenerator() {}
+
+		void setAction(int number, std::string code) { m_actionCode[number] = std::move(code); }
+		void emit(std::ostream& out, const std::string& className) const;
+
+		static std::map<int, std::string> expressionActions();
+
+	private:
+		void emitRule(std::ostream& out, int rule) const;
+		std::string actionCode(int number, const std::string& previous) const;
+
+	private:
+		Grammar m_grammar;
+		std::string m_sources;
+		bool m_semantic = false;
+		ActionTable m_actions;
+		std::map<int, std::string> m_actionCode;
+	};
+}
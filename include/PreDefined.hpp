@@ -1,11 +1,238 @@
 #pragma once
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <array>
+#include <cstdint>
 
-namespace PL0 
+namespace PL0
 {
-	using map = std::unordered_map<std::string, std::string>;
-	extern map KeyWords;
-	extern map OperatorWords;
-	extern map DelimiterWords;
-}
\ No newline at end of file
+	/**
+	 * @brief Fine-grained kind of a token; what the parser and printers switch on.
+	 */
+	enum class TokenKind : std::uint8_t
+	{
+		NONE,
+		// Keywords
+		BEGINSYM, CALLSYM, CONSTSYM, DOSYM, ENDSYM, IFSYM, ODDSYM,
+		PROCEDURESYM, READSYM, THENSYM, VARSYM, WHILESYM, WRITESYM,
+		// Operators
+		PLUS, MINUS, TIMES, SLASH, EQL, NEQ, LSS, LEQ, GTR, GEQ, BECOMES,
+		// Delimiters
+		LPAREN, RPAREN, COMMA, SEMICOLON, PERIOD,
+		IDENT,
+		NUMBER,
+		ENDOFFILE,
+		COUNT
+	};
+
+	struct TokenSpelling
+	{
+		std::string_view spelling;
+		TokenKind kind;
+	};
+
+	constexpr std::array<TokenSpelling, 13> KeyWords = { {
+		{ "begin", TokenKind::BEGINSYM },
+		{ "call", TokenKind::CALLSYM },
+		{ "const", TokenKind::CONSTSYM },
+		{ "do", TokenKind::DOSYM },
+		{ "end", TokenKind::ENDSYM },
+		{ "if", TokenKind::IFSYM },
+		{ "odd", TokenKind::ODDSYM },
+		{ "procedure", TokenKind::PROCEDURESYM },
+		{ "read", TokenKind::READSYM },
+		{ "then", TokenKind::THENSYM },
+		{ "var", TokenKind::VARSYM },
+		{ "while", TokenKind::WHILESYM },
+		{ "write", TokenKind::WRITESYM }
+	} };
+
+	constexpr std::array<TokenSpelling, 11> OperatorWords = { {
+		{ "+", TokenKind::PLUS },
+		{ "-", TokenKind::MINUS },
+		{ "*", TokenKind::TIMES },
+		{ "/", TokenKind::SLASH },
+		{ "=", TokenKind::EQL },
+		{ "#", TokenKind::NEQ },
+		{ "<", TokenKind::LSS },
+		{ "<=", TokenKind::LEQ },
+		{ ">", TokenKind::GTR },
+		{ ">=", TokenKind::GEQ },
+		{ ":=", TokenKind::BECOMES }
+	} };
+
+	constexpr std::array<TokenSpelling, 5> DelimiterWords = { {
+		{ "(", TokenKind::LPAREN },
+		{ ")", TokenKind::RPAREN },
+		{ ",", TokenKind::COMMA },
+		{ ";", TokenKind::SEMICOLON },
+		{ ".", TokenKind::PERIOD }
+	} };
+
+	constexpr std::array<std::string_view, static_cast<size_t>(TokenKind::COUNT)> TokenKindNames = {
+		"error",
+		"beginsym", "callsym", "constsym", "dosym", "endsym", "ifsym", "oddsym",
+		"proceduresym", "readsym", "thensym", "varsym", "whilesym", "writesym",
+		"plus", "minus", "times", "slash", "eql", "neq", "lss", "leq", "gtr", "geq", "becomes",
+		"lparen", "rparen", "comma", "semicolon", "period",
+		"ident",
+		"number",
+		"eof"
+	};
+
+	constexpr std::string_view tokenKindName(TokenKind kind)
+	{
+		return TokenKindNames[static_cast<size_t>(kind)];
+	}
+
+	constexpr bool isKeyWordKind(TokenKind kind) { return kind >= TokenKind::BEGINSYM && kind <= TokenKind::WRITESYM; }
+	constexpr bool isOperatorKind(TokenKind kind) { return kind >= TokenKind::PLUS && kind <= TokenKind::BECOMES; }
+	constexpr bool isDelimiterKind(TokenKind kind) { return kind >= TokenKind::LPAREN && kind <= TokenKind::PERIOD; }
+
+	/**
+	 * @brief Perfect hash over the keywords: the first two letters and the length, folded
+	 *        case-insensitively, multiplied by a seed and reduced to the top 5 bits.
+	 *
+	 * @note `KeyWordHashSeed` was found by an offline search; `isPerfectKeyWordHash` checks
+	 *       at compile time that no two keywords share a slot.
+	 */
+	constexpr std::uint32_t KeyWordHashBits = 5;
+	constexpr std::uint32_t KeyWordHashSeed = 82717;
+	constexpr size_t KeyWordMinLength = 2;
+	constexpr size_t KeyWordMaxLength = 9;
+
+	constexpr std::uint32_t keyWordHash(std::string_view word)
+	{
+		std::uint32_t key = static_cast<std::uint32_t>(static_cast<unsigned char>(word[0]) | 0x20)
+			| static_cast<std::uint32_t>(static_cast<unsigned char>(word[1]) | 0x20) << 8
+			| static_cast<std::uint32_t>(word.size()) << 16;
+		return (key * KeyWordHashSeed) >> (32 - KeyWordHashBits);
+	}
+
+	constexpr std::array<TokenSpelling, 1 << KeyWordHashBits> makeKeyWordSlots()
+	{
+		std::array<TokenSpelling, 1 << KeyWordHashBits> slots{};
+		for (auto& keyword : KeyWords)
+			slots[keyWordHash(keyword.spelling)] = keyword;
+		return slots;
+	}
+
+	inline constexpr std::array<TokenSpelling, 1 << KeyWordHashBits> KeyWordSlots = makeKeyWordSlots();
+
+	constexpr bool isPerfectKeyWordHash()
+	{
+		size_t used = 0;
+		for (auto& slot : KeyWordSlots)
+			used += slot.kind != TokenKind::NONE;
+		return used == KeyWords.size();
+	}
+
+	static_assert(isPerfectKeyWordHash(), "keyword hash has collisions; pick another KeyWordHashSeed");
+
+	/**
+	 * @brief Keyword kind of `word` compared case-insensitively, or `TokenKind::NONE`.
+	 */
+	constexpr TokenKind lookupKeyWord(std::string_view word)
+	{
+		if (word.size() < KeyWordMinLength || word.size() > KeyWordMaxLength)
+			return TokenKind::NONE;
+
+		const TokenSpelling& slot = KeyWordSlots[keyWordHash(word)];
+		if (slot.spelling.size() != word.size())
+			return TokenKind::NONE;
+		for (size_t i = 0; i < word.size(); i++)
+			if ((static_cast<unsigned char>(word[i]) | 0x20) != static_cast<unsigned char>(slot.spelling[i]))
+				return TokenKind::NONE;
+		return slot.kind;
+	}
+
+	/**
+	 * @brief Lexical class of a source byte; decides which scanner handles the next token.
+	 */
+	enum class CharClass : std::uint8_t
+	{
+		OTHER,
+		SPACE,
+		LETTER,
+		DIGIT,
+		SYMBOL,     // First character of an operator or delimiter (':' included).
+		END         // '\0', end of input.
+	};
+
+	constexpr std::array<CharClass, 256> makeCharClassTable()
+	{
+		std::array<CharClass, 256> table{};
+		for (auto& cls : table)
+			cls = CharClass::OTHER;
+		for (unsigned char c : std::string_view(" \t\r\n"))
+			table[c] = CharClass::SPACE;
+		for (unsigned c = 'a'; c <= 'z'; c++)
+			table[c] = table[c - 'a' + 'A'] = CharClass::LETTER;
+		for (unsigned c = '0'; c <= '9'; c++)
+			table[c] = CharClass::DIGIT;
+		for (auto& op : OperatorWords)
+			table[static_cast<unsigned char>(op.spelling[0])] = CharClass::SYMBOL;
+		for (auto& delimiter : DelimiterWords)
+			table[static_cast<unsigned char>(delimiter.spelling[0])] = CharClass::SYMBOL;
+		table['\0'] = CharClass::END;
+		return table;
+	}
+
+	inline constexpr std::array<CharClass, 256> CharClassTable = makeCharClassTable();
+
+	constexpr CharClass charClass(char c)
+	{
+		return CharClassTable[static_cast<unsigned char>(c)];
+	}
+
+	/**
+	 * @brief Trie-shaped DFA recognising every operator and delimiter by longest match.
+	 *
+	 * @note `next[state][byte]` is 0 when there is no transition. `accept[state]` is the
+	 *       kind recognised in that state, or `TokenKind::NONE` for a dead end such as ':'.
+	 */
+	struct SymbolDFA
+	{
+		static constexpr size_t MaxStates = 1 + 2 * (OperatorWords.size() + DelimiterWords.size());
+
+		std::array<std::array<std::uint8_t, 256>, MaxStates> next{};
+		std::array<TokenKind, MaxStates> accept{};
+		size_t states = 1;
+
+		constexpr void add(std::string_view spelling, TokenKind kind)
+		{
+			size_t state = 0;
+			for (unsigned char c : spelling)
+			{
+				if (next[state][c] == 0)
+					next[state][c] = static_cast<std::uint8_t>(states++);
+				state = next[state][c];
+			}
+			accept[state] = kind;
+		}
+	};
+
+	constexpr SymbolDFA makeSymbolDFA()
+	{
+		SymbolDFA dfa{};
+		for (auto& op : OperatorWords)
+			dfa.add(op.spelling, op.kind);
+		for (auto& delimiter : DelimiterWords)
+			dfa.add(delimiter.spelling, delimiter.kind);
+		return dfa;
+	}
+
+	inline constexpr SymbolDFA SymbolTable = makeSymbolDFA();
+
+	/**
+	 * @brief Operator or delimiter kind spelled exactly by `word`, or `TokenKind::NONE`.
+	 */
+	constexpr TokenKind lookupSymbol(std::string_view word)
+	{
+		std::uint8_t state = 0;
+		for (unsigned char c : word)
+			if ((state = SymbolTable.next[state][c]) == 0)
+				return TokenKind::NONE;
+		return SymbolTable.accept[state];
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+
+namespace PL0
+{
+	/**
+	 * @brief Instruction set used by the bulk scanners, picked from the CPU on first use.
+	 */
+	enum class ScanLevel
+	{
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	ScanLevel scanLevel();
+
+	/**
+	 * @brief Offset of the first byte in [pos, size) that is not ' ', '\t', '\r' or '\n'
+	 *        (`size` if there is none). `newlines` is increased by the '\n's skipped.
+	 */
+	size_t skipWhitespace(const char* data, size_t pos, size_t size, size_t& newlines);
+
+	/**
+	 * @brief Offset of the first '}' or '\0' in [pos, size) (`size` if there is none).
+	 *        `newlines` is increased by the '\n's skipped.
+	 */
+	size_t findCommentEnd(const char* data, size_t pos, size_t size, size_t& newlines);
+}
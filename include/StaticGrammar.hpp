@@ -0,0 +1,354 @@
+#pragma once
+#include "LL1Parser.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <format>
+#include <string_view>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief A string literal usable as a template argument.
+	 */
+	template <size_t N>
+	struct FixedString
+	{
+		char text[N] = {};
+
+		constexpr FixedString(const char (&str)[N])
+		{
+			for (size_t i = 0; i < N; i++)
+				text[i] = str[i];
+		}
+
+		constexpr std::string_view view() const { return { text, N - 1 }; }
+	};
+
+	// Compiled grammars spell each symbol with one character, so their ids fit in a byte.
+	using CompactSymbol = std::uint8_t;
+
+	namespace GrammarCompiler
+	{
+		// Calls `visit(left, right)` for every "X->..." line; blank lines and a trailing '\r' are skipped.
+		template <typename Visit>
+		constexpr void forEachRule(std::string_view rules, Visit visit)
+		{
+			for (size_t begin = 0; begin < rules.size(); )
+			{
+				size_t end = rules.find('\n', begin);
+				if (end == std::string_view::npos)
+					end = rules.size();
+				std::string_view line = rules.substr(begin, end - begin);
+				if (!line.empty() && line.back() == '\r')
+					line.remove_suffix(1);
+				if (line.size() > 3)
+					visit(line[0], line.substr(3));
+				begin = end + 1;
+			}
+		}
+
+		constexpr bool isNonterminalChar(char c) { return c >= 'A' && c <= 'Z'; }
+
+		/**
+		 * @brief Sizes of a grammar's tables, computed first so the tables can be exact-size arrays.
+		 */
+		struct Shape
+		{
+			size_t rules = 0;
+			size_t nonterminals = 0;
+			size_t symbols = 0;     // Nonterminals, terminals and '#'.
+			size_t rhs = 0;         // Right-side symbols over all rules, without 'e'.
+		};
+
+		constexpr Shape measure(std::string_view rules)
+		{
+			Shape shape;
+			bool seen[256] = {};
+			size_t terminals = 0;
+			forEachRule(rules, [&](char left, std::string_view) {
+				shape.rules++;
+				if (!seen[static_cast<unsigned char>(left)])
+					shape.nonterminals++;
+				seen[static_cast<unsigned char>(left)] = true;
+			});
+			forEachRule(rules, [&](char, std::string_view right) {
+				for (char c : right)
+				{
+					if (c == 'e')
+						continue;
+					shape.rhs++;
+					if (!isNonterminalChar(c) && c != '#' && !seen[static_cast<unsigned char>(c)])
+						terminals++;
+					if (!isNonterminalChar(c))
+						seen[static_cast<unsigned char>(c)] = true;
+				}
+			});
+			shape.symbols = shape.nonterminals + terminals + 1;
+			return shape;
+		}
+
+		/**
+		 * @brief The tables of Grammar, as exact-size arrays built during constant evaluation.
+		 *
+		 * @note The predict table has one extra column, always empty, that bytes outside the grammar map to.
+		 */
+		template <Shape S>
+		struct Tables
+		{
+			static constexpr size_t Columns = S.symbols + 1;
+			static constexpr CompactSymbol Unknown = static_cast<CompactSymbol>(S.symbols);
+
+			std::array<char, S.symbols> symbols{};
+			std::array<CompactSymbol, 256> symbolId{};
+			std::array<std::uint16_t, S.rules + 1> rhsStart{};
+			std::array<CompactSymbol, (S.rhs > 0 ? S.rhs : 1)> rhs{};
+			std::array<std::int16_t, S.nonterminals * Columns> table{};
+			CompactSymbol endMarker = 0;
+			size_t undefined = 0;   // Uppercase symbols that are never a left side.
+			size_t conflicts = 0;   // Predict table cells claimed by two different rules.
+
+			constexpr bool isNonterminal(CompactSymbol symbol) const { return symbol < S.nonterminals; }
+			constexpr int predict(CompactSymbol nonterminal, CompactSymbol terminal) const { return table[nonterminal * Columns + terminal]; }
+		};
+
+		template <Shape S>
+		constexpr Tables<S> compile(std::string_view rules)
+		{
+			static_assert(S.symbols < 255, "too many grammar symbols");
+			Tables<S> t;
+			using Set = std::array<bool, S.symbols>;
+
+			size_t count = 0;
+			auto addSymbol = [&](char c) {
+				if (t.symbolId[static_cast<unsigned char>(c)] == t.Unknown)
+				{
+					t.symbols[count] = c;
+					t.symbolId[static_cast<unsigned char>(c)] = static_cast<CompactSymbol>(count++);
+				}
+			};
+			t.symbolId.fill(t.Unknown);
+			forEachRule(rules, [&](char left, std::string_view) { addSymbol(left); });
+			forEachRule(rules, [&](char, std::string_view right) {
+				for (char c : right)
+					if (!isNonterminalChar(c) && c != 'e' && c != '#')
+						addSymbol(c);
+			});
+			addSymbol('#');
+			t.endMarker = t.symbolId['#'];
+
+			// Right sides, reversed for pushing, and their left sides.
+			std::array<CompactSymbol, S.rules> left{};
+			size_t rule = 0, at = 0;
+			forEachRule(rules, [&](char l, std::string_view right) {
+				left[rule] = t.symbolId[static_cast<unsigned char>(l)];
+				for (size_t i = right.size(); i-- > 0; )
+				{
+					if (right[i] == 'e')
+						continue;
+					CompactSymbol symbol = t.symbolId[static_cast<unsigned char>(right[i])];
+					if (symbol == t.Unknown)
+						t.undefined++;
+					t.rhs[at++] = symbol;
+				}
+				t.rhsStart[++rule] = static_cast<std::uint16_t>(at);
+			});
+
+			// FIRST of a rule's right side, and whether all of it can vanish.
+			std::array<bool, S.nonterminals> nullable{};
+			std::array<Set, S.nonterminals> first{};
+			auto firstOfRight = [&](size_t r, Set& out) {
+				for (size_t i = t.rhsStart[r + 1]; i-- > t.rhsStart[r]; )
+				{
+					CompactSymbol symbol = t.rhs[i];
+					if (!t.isNonterminal(symbol))
+					{
+						if (symbol != t.Unknown)
+							out[symbol] = true;
+						return false;
+					}
+					for (size_t k = 0; k < S.symbols; k++)
+						out[k] = out[k] || first[symbol][k];
+					if (!nullable[symbol])
+						return false;
+				}
+				return true;
+			};
+
+			// Grammars here are small, so plain iteration to a fixpoint is cheap enough at compile time.
+			for (bool changed = true; changed; )
+			{
+				changed = false;
+				for (size_t r = 0; r < S.rules; r++)
+				{
+					Set grown = first[left[r]];
+					bool vanishes = firstOfRight(r, grown);
+					if (grown != first[left[r]] || (vanishes && !nullable[left[r]]))
+						changed = true;
+					first[left[r]] = grown;
+					nullable[left[r]] = nullable[left[r]] || vanishes;
+				}
+			}
+
+			std::array<Set, S.nonterminals> follow{};
+			follow[0][t.endMarker] = true;
+			for (bool changed = true; changed; )
+			{
+				changed = false;
+				for (size_t r = 0; r < S.rules; r++)
+				{
+					Set trailer = follow[left[r]];
+					for (size_t i = t.rhsStart[r]; i < t.rhsStart[r + 1]; i++)
+					{
+						CompactSymbol symbol = t.rhs[i];
+						if (!t.isNonterminal(symbol))
+						{
+							trailer = {};
+							if (symbol != t.Unknown)
+								trailer[symbol] = true;
+							continue;
+						}
+						for (size_t k = 0; k < S.symbols; k++)
+							if (trailer[k] && !follow[symbol][k])
+								changed = follow[symbol][k] = true;
+						if (!nullable[symbol])
+							trailer = {};
+						for (size_t k = 0; k < S.symbols; k++)
+							trailer[k] = trailer[k] || first[symbol][k];
+					}
+				}
+			}
+
+			t.table.fill(Grammar::NoProduction);
+			for (size_t r = 0; r < S.rules; r++)
+			{
+				Set predicted{};
+				if (firstOfRight(r, predicted))
+					for (size_t k = 0; k < S.symbols; k++)
+						predicted[k] = predicted[k] || follow[left[r]][k];
+				for (size_t k = S.nonterminals; k < S.symbols; k++)
+				{
+					if (!predicted[k])
+						continue;
+					std::int16_t& cell = t.table[left[r] * t.Columns + k];
+					if (cell != Grammar::NoProduction && cell != static_cast<std::int16_t>(r))
+						t.conflicts++;
+					cell = static_cast<std::int16_t>(r);
+				}
+			}
+			return t;
+		}
+	}
+
+	/**
+	 * @brief LL(1) recogniser for a grammar fixed at compile time, in the rules.txt format.
+	 *
+	 * @note FIRST, FOLLOW and the predict table are computed during constant evaluation, so the
+	 *       tables are constants in the binary and there is nothing to build at startup. A grammar
+	 *       that is not LL(1), or uses an uppercase symbol with no rules, fails to compile. The
+	 *       runtime `Grammar` remains the path for rules read from a file.
+	 */
+	template <FixedString Rules>
+	class StaticParser
+	{
+	public:
+		static constexpr GrammarCompiler::Shape Shape = GrammarCompiler::measure(Rules.view());
+		static constexpr GrammarCompiler::Tables<Shape> Tables = GrammarCompiler::compile<Shape>(Rules.view());
+		static_assert(Tables.undefined == 0, "grammar uses a nonterminal that has no rules");
+		static_assert(Tables.conflicts == 0, "grammar is not LL(1): two rules share a predict table cell");
+
+		ParseResult parse(const TokenBuffer& tokens) const
+		{
+			return run([&tokens](size_t i) { return i < tokens.size() ? tokens.kinds[i] : TokenKind::ENDOFFILE; });
+		}
+
+		ParseResult parse(Lexer& lexer) const
+		{
+			return run([&lexer](size_t) { return lexer.nextTokenView().kind; });
+		}
+
+	private:
+		static constexpr std::array<CompactSymbol, static_cast<size_t>(TokenKind::COUNT)> KindSymbols = [] {
+			std::array<CompactSymbol, static_cast<size_t>(TokenKind::COUNT)> ids{};
+			for (size_t kind = 0; kind < ids.size(); kind++)
+				ids[kind] = Tables.symbolId[static_cast<unsigned char>(terminalOf(static_cast<TokenKind>(kind)))];
+			return ids;
+		}();
+
+		static constexpr char spelling(CompactSymbol symbol)
+		{
+			return symbol < Shape.symbols ? Tables.symbols[symbol] : '?';
+		}
+
+		static constexpr size_t LongestRight = [] {
+			size_t longest = 0;
+			for (size_t r = 0; r < Shape.rules; r++)
+				longest = std::max<size_t>(longest, Tables.rhsStart[r + 1] - Tables.rhsStart[r]);
+			return longest;
+		}();
+
+		// `kindAt(i)` returns the kind of token i; it is called once per token, in order.
+		template <typename KindAt>
+		ParseResult run(KindAt kindAt) const
+		{
+			// Room for the longest right side is kept free, so an expansion is a plain copy.
+			std::vector<CompactSymbol> stack(64 + LongestRight);
+			size_t depth = 0;
+			stack[depth++] = Tables.endMarker;
+			stack[depth++] = 0;
+
+			size_t token = 0;
+			TokenKind kind = kindAt(token);
+			CompactSymbol c = KindSymbols[static_cast<size_t>(kind)];
+			while (true)
+			{
+				CompactSymbol top = stack[depth - 1];
+				if (Tables.isNonterminal(top))
+				{
+					int rule = Tables.predict(top, c);
+					if (rule == Grammar::NoProduction)
+						return { false, token, std::format("Error: No production found for {} and {}", spelling(top), terminalOf(kind)) };
+					depth--;
+					for (size_t i = Tables.rhsStart[rule]; i < Tables.rhsStart[rule + 1]; i++)
+						stack[depth++] = Tables.rhs[i];
+					if (stack.size() - depth < LongestRight)
+						stack.resize(stack.size() * 2);
+				}
+				else if (top == c)
+				{
+					if (top == Tables.endMarker)
+						return { true, 0, "Parse successfully!" };
+					depth--;
+					kind = kindAt(++token);
+					c = KindSymbols[static_cast<size_t>(kind)];
+				}
+				else if (top == Tables.endMarker)
+					return { false, token, "Parse failed,extra symbols appeared." };
+				else
+					return { false, token, std::format("Signal {} not found in expression", spelling(top)) };
+			}
+		}
+	};
+
+	/**
+	 * @brief The expression grammar of test/test3/rules.txt.
+	 */
+	inline constexpr FixedString ExpressionRules =
+		"E->+B\n"
+		"E->-B\n"
+		"E->B\n"
+		"B->TG\n"
+		"G->+TG\n"
+		"G->-TG\n"
+		"G->e\n"
+		"T->FS\n"
+		"S->*FS\n"
+		"S->/FS\n"
+		"S->e\n"
+		"F->i\n"
+		"F->n\n"
+		"F->(B)\n";
+
+	using ExpressionParser = StaticParser<ExpressionRules>;
+}
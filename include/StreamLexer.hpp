@@ -0,0 +1,59 @@
+#pragma once
+#include "Lexer.hpp"
+#include <istream>
+#include <memory>
+#include <optional>
+
+namespace PL0
+{
+	/**
+	 * @brief Lexer over a stream or file descriptor (stdin, pipes) that holds only a fixed-size buffer.
+	 *
+	 * @note The buffer is cut at token boundaries outside comments and each piece is lexed by a Lexer,
+	 *       so the tokens match lexing the whole input at once. Comment bodies are skipped without
+	 *       being buffered. A single token longer than the buffer throws InputTooLarge.
+	 *       Offsets count from the start of the stream. `text()` of a token stays valid until the
+	 *       next call to `nextToken()` or `nextTokenView()`. Errors are kept in `diagnostics()`; they
+	 *       are only rendered after `setErrorStream()`, as each buffered piece is retired, since its
+	 *       text goes with it.
+	 */
+	class StreamLexer
+	{
+	public:
+		static constexpr size_t DefaultBufferSize = 1 << 20;
+
+		explicit StreamLexer(std::istream& in, size_t bufferSize = DefaultBufferSize);
+		explicit StreamLexer(int fd, size_t bufferSize = DefaultBufferSize);
+		~StreamLexer() {}
+
+		StreamLexer(const StreamLexer&) = delete;
+		StreamLexer& operator=(const StreamLexer&) = delete;
+
+		Token nextToken();
+		TokenView nextTokenView();
+		std::string_view text(const TokenView& token) const;
+		std::string value(const TokenView& token) const;
+		void setErrorStream(std::ostream& stream) { m_errorStream = &stream; }
+		Diagnostics& diagnostics() { return m_diagnostics; }
+
+	private:
+		size_t read(char* data, size_t size);
+		bool refill();
+		void discard(size_t count);
+
+	private:
+		std::istream* m_in = nullptr;
+		int m_fd = -1;
+		std::unique_ptr<char[]> m_buffer;
+		size_t m_capacity;
+		size_t m_size = 0;                  // Bytes held in the buffer.
+		size_t m_window = 0;                // The current Lexer covers [0, m_window) of the buffer.
+		size_t m_base = 0;                  // Stream offset of the first byte in the buffer.
+		size_t m_line = 1;                  // Line of the first byte in the buffer.
+		bool m_insideComment = false;
+		bool m_exhausted = false;
+		std::optional<Lexer> m_lexer;
+		std::ostream* m_errorStream = nullptr;
+		Diagnostics m_diagnostics;
+	};
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace PL0
+{
+	/**
+	 * @brief Fixed-size pool of worker threads executing submitted tasks in FIFO order.
+	 *
+	 * @note Waiting on a future from `submit` inside a task of the same pool can deadlock once
+	 *       every worker waits. `forEach` does not wait on queued tasks, so it is safe there.
+	 */
+	class ThreadPool
+	{
+	public:
+		explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		size_t size() const { return m_workers.size(); }
+
+		template <typename F>
+		std::future<std::invoke_result_t<F>> submit(F&& task)
+		{
+			using Result = std::invoke_result_t<F>;
+			auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+			std::future<Result> future = packaged->get_future();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_tasks.emplace([packaged] { (*packaged)(); });
+			}
+			m_condition.notify_one();
+			return future;
+		}
+
+		// Runs work(0) .. work(count - 1) on the workers and on the calling thread, which takes
+		// indices too and then waits only for those a worker has already started. The first
+		// exception thrown by `work` is rethrown here once every started index has finished.
+		template <typename F>
+		void forEach(size_t count, F&& work)
+		{
+			struct Progress
+			{
+				std::atomic<size_t> next{ 0 };
+				std::atomic<size_t> done{ 0 };
+				std::exception_ptr error;
+				std::mutex errorMutex;
+			};
+			// Helpers that start after the last index is taken find nothing to do, so they only
+			// touch the shared progress, never `work`.
+			auto progress = std::make_shared<Progress>();
+			auto run = [progress, count, &work] {
+				for (size_t i; (i = progress->next.fetch_add(1)) < count; )
+				{
+					try
+					{
+						work(i);
+					}
+					catch (...)
+					{
+						std::lock_guard<std::mutex> lock(progress->errorMutex);
+						if (!progress->error)
+							progress->error = std::current_exception();
+					}
+					if (progress->done.fetch_add(1) + 1 == count)
+						progress->done.notify_all();
+				}
+			};
+
+			for (size_t helper = 1; helper < count && helper <= size(); helper++)
+				submit(run);
+			run();
+			for (size_t done; (done = progress->done.load()) < count; )
+				progress->done.wait(done);
+			if (progress->error)
+				std::rethrow_exception(progress->error);
+		}
+
+	private:
+		void workerLoop();
+
+	private:
+		std::vector<std::thread> m_workers;
+		std::queue<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stopping = false;
+	};
+}
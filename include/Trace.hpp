@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// Build with PL0_TRACE=0 to compile every trace call out of the parsers.
+#ifndef PL0_TRACE
+#define PL0_TRACE 1
+#endif
+
+namespace PL0
+{
+	class Grammar;
+
+	/**
+	 * @brief How much a parser reports about its steps.
+	 *
+	 * @note Every level above OFF records steps in the ring buffer. Only ERRORS dumps it on a
+	 *       failure, since the other two have already printed those steps.
+	 */
+	enum class TraceLevel : std::uint8_t
+	{
+		OFF,     // Nothing is recorded.
+		ERRORS,  // Steps go to the ring buffer, which is dumped when the parse fails.
+		STEPS,   // Each step is written out as one line when it happens.
+		STACKS   // The whole parse stack and the lookahead are written out before every step.
+	};
+
+	enum class TraceEvent : std::uint8_t
+	{
+		MATCH,       // `symbol` matched the lookahead token.
+		EXPAND,      // `symbol` was replaced by rule `detail`.
+		ACTION,      // Semantic action `detail` ran.
+		SYNTHESIZE,  // The synthesized value of `symbol` was handed down.
+		FAIL         // No rule or match for `symbol` and the lookahead token.
+	};
+
+	/**
+	 * @brief One parse step as a fixed-size record; it is only turned into text when dumped.
+	 */
+	struct TraceStep
+	{
+		std::uint32_t offset;  // Lookahead token in the source.
+		std::uint32_t length;
+		std::uint32_t depth;   // Stack size before the step.
+		std::int32_t detail;
+		std::uint16_t symbol;
+		TraceEvent event;
+	};
+
+	/**
+	 * @brief Keeps the most recent parse steps in a ring buffer and decides what gets printed.
+	 *
+	 * @note The capacity is rounded up to a power of two, so recording is one masked store.
+	 *       With `PL0_TRACE` set to 0 `enabled()` is a constant false and callers drop the calls.
+	 */
+	class Tracer
+	{
+	public:
+		static constexpr bool Compiled = PL0_TRACE != 0;
+
+		explicit Tracer(TraceLevel level = TraceLevel::ERRORS, size_t capacity = 64);
+
+		void setLevel(TraceLevel level) { m_level = level; }
+		TraceLevel level() const { return m_level; }
+
+		bool enabled(TraceLevel level) const
+		{
+			if constexpr (Compiled)
+				return m_level >= level;
+			else
+				return false;
+		}
+
+		void record(const TraceStep& step)
+		{
+			m_steps[m_recorded++ & (m_steps.size() - 1)] = step;
+		}
+
+		void clear() { m_recorded = 0; }
+		size_t recorded() const { return m_recorded; }
+		size_t size() const { return m_recorded < m_steps.size() ? m_recorded : m_steps.size(); }
+		size_t capacity() const { return m_steps.size(); }
+
+		// The i-th step still held, oldest first.
+		const TraceStep& operator[](size_t i) const
+		{
+			return m_steps[(m_recorded - size() + i) & (m_steps.size() - 1)];
+		}
+		const TraceStep& latest() const { return (*this)[size() - 1]; }
+
+		void dump(std::ostream& out, const Grammar& grammar, std::string_view source) const;
+		static void render(std::ostream& out, const TraceStep& step, const Grammar& grammar, std::string_view source);
+
+	private:
+		std::vector<TraceStep> m_steps;
+		size_t m_recorded = 0;
+		TraceLevel m_level;
+	};
+}
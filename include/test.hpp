@@ -1,129 +1,749 @@
 #pragma once
 #include "PL0.hpp"
+#include "IncrementalParser.hpp"
+#include "StaticGrammar.hpp"
+#include "StreamLexer.hpp"
+#include "ParserGenerator.hpp"
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 void test2(std::string infile,std::string outaddress) 
 {
 	PL0::Lexer lexer(infile);
 	std::ofstream out(outaddress);
 
-	for (auto token = lexer.nextToken(); token.type != PL0::TokenType::ENDOFFILE; token = lexer.nextToken()) {
-		if (token.type == PL0::TokenType::KEYWORD) {
-			auto it = PL0::KeyWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+	PL0::TokenBuffer tokens = lexer.tokenizeAll();
+	lexer.printDiagnostics();
+	for (size_t i = 0; i < tokens.size(); i++)
+		out << "(" << PL0::tokenKindName(tokens.kinds[i]) << "," << lexer.value(tokens[i]) << ")" << std::endl;
+	out.close();
+}
+
+void test3(std::string infile) 
+{
+	PL0::Lexer lexer(infile);
+
+	std::string rules = "test/test3/rules.txt";
+	PL0::LL1Parser Parser(rules);
+	Parser.m_trace.setLevel(PL0::TraceLevel::STACKS);
+	Parser.m_grammar.printPredictTable();
+	Parser.parse(lexer);
+	lexer.printDiagnostics();
+};
+
+// test3 on the parser compiled from the same grammar at build time.
+void test3Static(std::string infile)
+{
+	PL0::Lexer lexer(infile);
+	PL0::ExpressionParser parser;
+	PL0::ParseResult result = parser.parse(lexer);
+	lexer.printDiagnostics();
+	std::cout << result.message << std::endl;
+	if (!result.accepted)
+		std::cout << "At token " << result.errorToken << std::endl;
+};
+
+void test4(std::string infile, std::string outaddress) 
+{
+	PL0::Lexer lexer(infile);
+
+	std::string rules = "test/test4/rules.txt";
+	PL0::LL1Parser Parser(lexer, rules);
+	Parser.m_trace.setLevel(PL0::TraceLevel::STACKS);
+
+	std::string L_SDT="test/test4/L-SDT.txt";
+	Parser.getL_sdtFile(L_SDT);
+	//Parser.parse();
+	Parser.semanticParse();
+	lexer.printDiagnostics();
+
+};
+
+// A PL/0 program of about `bytes` bytes: a run of declarations, assignments with every operator,
+// conditions and comments, repeated with fresh names on every line.
+std::string generatedProgram(size_t bytes)
+{
+	std::string text;
+	text.reserve(bytes + 128);
+	for (size_t i = 0; text.size() < bytes; i++)
+		text += std::format("var x{0}, y{0}; {{ block {0} }}\nbegin x{0} := (x{0} + {1}) * y{0} - 7 / 3; if x{0} >= {1} then y{0} := y{0} # 2; "
+			"while x{0} <= 99 do x{0} := x{0} + 1 end;\n", i, i % 1000);
+	return text;
+}
+
+// Times tokenising generated programs of 1 KB to `maxBytes` bytes, repeating the small ones, and
+// prints tokens per second for each size; lexing is linear, so the rate should stay flat.
+void benchLexer(size_t maxBytes = 100'000'000)
+{
+	for (size_t bytes = 1000; bytes <= maxBytes; bytes *= 10)
+	{
+		std::string text = generatedProgram(bytes);
+		size_t rounds = std::max<size_t>(1, 100'000'000 / text.size());
+		size_t tokens = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (size_t round = 0; round < rounds; round++)
+		{
+			PL0::Lexer lexer(PL0::SourceText{ text });
+			while (lexer.nextTokenView().kind != PL0::TokenKind::ENDOFFILE)
+				tokens++;
 		}
-		else if (token.type == PL0::TokenType::OPERATOR) {
-			auto it = PL0::OperatorWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << std::format("{:10} bytes x {:6}: {:10} tokens, {:8.1f} ms, {:6.1f} M tokens/s\n",
+			text.size(), rounds, tokens, elapsed.count() * 1000, tokens / elapsed.count() / 1e6);
+	}
+}
+
+// Times operator and delimiter dispatch on `symbols` symbols through the SymbolDFA against a
+// reference in the old style, which probes an unordered_map with one- and two-character strings,
+// and checks both find the same kinds. The whole Lexer on the same text is timed too.
+void benchSymbols(size_t symbols = 10'000'000)
+{
+	std::vector<std::string_view> spellings;
+	for (auto& word : PL0::OperatorWords)
+		spellings.push_back(word.spelling);
+	for (auto& word : PL0::DelimiterWords)
+		spellings.push_back(word.spelling);
+	std::string text;
+	for (size_t i = 0; i < symbols; i++)
+	{
+		text += spellings[(i * 7 + i / spellings.size()) % spellings.size()];
+		text += ' ';
+	}
+
+	std::vector<PL0::TokenKind> dfaKinds, mapKinds;
+	dfaKinds.reserve(symbols);
+	mapKinds.reserve(symbols);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t pos = 0; pos < text.size(); )
+	{
+		if (PL0::charClass(text[pos]) == PL0::CharClass::SPACE)
+		{
+			pos++;
+			continue;
+		}
+		std::uint8_t state = 0;
+		for (std::uint8_t next; pos < text.size() && (next = PL0::SymbolTable.next[state][static_cast<unsigned char>(text[pos])]) != 0; state = next)
+			pos++;
+		dfaKinds.push_back(PL0::SymbolTable.accept[state]);
+	}
+	std::chrono::duration<double, std::milli> dfa = std::chrono::steady_clock::now() - start;
+
+	std::unordered_map<std::string, PL0::TokenKind> words;
+	for (auto& word : PL0::OperatorWords)
+		words.emplace(word.spelling, word.kind);
+	for (auto& word : PL0::DelimiterWords)
+		words.emplace(word.spelling, word.kind);
+	start = std::chrono::steady_clock::now();
+	for (size_t pos = 0; pos < text.size(); )
+	{
+		if (text[pos] == ' ')
+		{
+			pos++;
+			continue;
 		}
-		else if (token.type == PL0::TokenType::DELIMITER) {
-			auto it = PL0::DelimiterWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+		std::string one(1, text[pos]);
+		auto found = words.end();
+		if (pos + 1 < text.size())
+			found = words.find(one + text[pos + 1]);
+		if (found != words.end())
+			pos += 2;
+		else
+		{
+			found = words.find(one);
+			pos++;
 		}
-		else if (token.type == PL0::TokenType::IDENTIFIER)
-			out << "(ident," << token.value << ")" << std::endl;
-		else if (token.type == PL0::TokenType::NUMBER)
-			out << "(number," << token.value << ")" << std::endl;
-		else if (token.type == PL0::TokenType::NONE)
-			out << "(error," << token.value << ")" << std::endl;
+		mapKinds.push_back(found == words.end() ? PL0::TokenKind::NONE : found->second);
 	}
-	out.close();
+	std::chrono::duration<double, std::milli> map = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	PL0::Lexer lexer(PL0::SourceText{ text });
+	size_t tokens = 0;
+	while (lexer.nextTokenView().kind != PL0::TokenKind::ENDOFFILE)
+		tokens++;
+	std::chrono::duration<double, std::milli> whole = std::chrono::steady_clock::now() - start;
+
+	std::cout << std::format("{} symbols: DFA {:8.1f} ms, map {:8.1f} ms, Lexer {:8.1f} ms ({} tokens){}\n",
+		dfaKinds.size(), dfa.count(), map.count(), whole.count(), tokens, dfaKinds == mapKinds ? "" : ", DFA and map DIFFER");
 }
 
-void test3(std::string infile) 
+// Times tokenising a generated program of `bytes` bytes one owning Token at a time with nextToken,
+// in batches of 4096 into one reused TokenBuffer with nextTokens, and all at once with tokenizeAll.
+// Beside them it times nextTokenView storing nothing, the floor for any of the three, and filling
+// fresh columns as large as tokenizeAll's, which is what keeping every token costs over nextTokens.
+// The same text is then written to a file and tokenised with tokenizeAll after reading it in and
+// after mapping it, opening included; both must give the tokens of the in-memory run.
+void benchTokenize(size_t bytes = 32'000'000)
 {
-	PL0::Lexer lexer(infile);
-	std::ofstream out("test/test3/temp.txt");
+	std::string text = generatedProgram(bytes);
+	auto start = std::chrono::steady_clock::now();
+	size_t single = 0;
+	{
+		PL0::Lexer lexer(PL0::SourceText{ text });
+		while (lexer.nextToken().kind != PL0::TokenKind::ENDOFFILE)
+			single++;
+	}
+	std::chrono::duration<double, std::milli> perToken = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	size_t batched = 0;
+	{
+		PL0::Lexer lexer(PL0::SourceText{ text });
+		PL0::TokenBuffer buffer;
+		buffer.reserve(4096);
+		for (size_t count; (count = lexer.nextTokens(buffer, 4096)) != 0; buffer.clear())
+			batched += count;
+	}
+	std::chrono::duration<double, std::milli> perBatch = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	PL0::Lexer lexer(PL0::SourceText{ text });
+	PL0::TokenBuffer whole = lexer.tokenizeAll();
+	std::chrono::duration<double, std::milli> all = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	size_t viewed = 0;
+	{
+		PL0::Lexer viewLexer(PL0::SourceText{ text });
+		while (viewLexer.nextTokenView().kind != PL0::TokenKind::ENDOFFILE)
+			viewed++;
+	}
+	std::chrono::duration<double, std::milli> lexOnly = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	{
+		PL0::TokenBuffer columns;
+		columns.kinds.resize(whole.size());
+		columns.offsets.resize(whole.size());
+		columns.lengths.resize(whole.size());
+		columns.values.resize(whole.size());
+	}
+	std::chrono::duration<double, std::milli> fill = std::chrono::steady_clock::now() - start;
+
+	std::cout << std::format("{} bytes, {} tokens: nextToken {:8.1f} ms, nextTokens {:8.1f} ms, tokenizeAll {:8.1f} ms{}\n",
+		text.size(), single, perToken.count(), perBatch.count(), all.count(),
+		single == batched && single == whole.size() && single == viewed ? "" : ", token counts DIFFER");
+	std::cout << std::format("nextTokenView alone {:8.1f} ms, filling {} MB of fresh columns {:8.1f} ms\n",
+		lexOnly.count(), whole.size() * (sizeof(PL0::TokenKind) + 2 * sizeof(std::uint32_t) + sizeof(std::int64_t)) >> 20,
+		fill.count());
+
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "benchTokenize.pl0";
+	std::ofstream(file, std::ios::binary) << text;
+	for (PL0::InputMode mode : { PL0::InputMode::BUFFERED, PL0::InputMode::MAPPED })
+	{
+		start = std::chrono::steady_clock::now();
+		PL0::Lexer fileLexer(file.string(), mode);
+		PL0::TokenBuffer tokens = fileLexer.tokenizeAll();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		bool same = tokens.kinds == whole.kinds && tokens.offsets == whole.offsets
+			&& tokens.lengths == whole.lengths && tokens.values == whole.values;
+		std::cout << std::format("{} file: tokenizeAll {:8.1f} ms{}\n", mode == PL0::InputMode::MAPPED ? "mapped" : "read",
+			elapsed.count(), same ? "" : ", DIFFERENT from the in-memory run");
+	}
+	std::filesystem::remove(file);
+}
+
+// Times tokenising a generated program of `bytes` bytes with tokenizeAll and with tokenizeParallel
+// on 1, 2, 4 and 8 threads (more on bigger machines), and checks every run gives the same tokens.
+void benchParallelLexer(size_t bytes = 100'000'000)
+{
+	std::string text = generatedProgram(bytes);
+	auto start = std::chrono::steady_clock::now();
+	PL0::Lexer sequential(PL0::SourceText{ text });
+	PL0::TokenBuffer expected = sequential.tokenizeAll();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::format("{} bytes, {} tokens: tokenizeAll {:8.1f} ms\n", text.size(), expected.size(), elapsed.count());
+
+	// Past the core count the extra threads only time-slice, which measures the overhead of the split.
+	size_t last = std::max<size_t>(8, std::thread::hardware_concurrency());
+	for (size_t threads = 1; threads <= last; threads *= 2)
+	{
+		PL0::ThreadPool pool(threads);
+		start = std::chrono::steady_clock::now();
+		PL0::Lexer lexer(PL0::SourceText{ text });
+		PL0::TokenBuffer tokens = lexer.tokenizeParallel(pool);
+		elapsed = std::chrono::steady_clock::now() - start;
+
+		bool same = tokens.kinds == expected.kinds && tokens.offsets == expected.offsets
+			&& tokens.lengths == expected.lengths && tokens.values == expected.values;
+		std::cout << std::format("{:3} threads: tokenizeParallel {:8.1f} ms{}\n",
+			threads, elapsed.count(), same ? "" : ", DIFFERENT from tokenizeAll");
+	}
+}
+
+// Lexes `errors` unknown symbols with the error records limited to `limit`, sequentially and on a
+// pool, and checks that both keep exactly `limit` records, count the rest as dropped and hand the
+// kept ones over in source order through drain, which leaves the sink empty.
+void testDiagnostics(size_t errors = 100'000, size_t limit = 100)
+{
+	std::string text;
+	for (size_t i = 0; i < errors; i++)
+		text += i % 64 == 63 ? "$\n" : "$ ";
+
+	PL0::ThreadPool pool(2);
+	for (bool parallel : { false, true })
+	{
+		PL0::Lexer lexer(PL0::SourceText{ text });
+		lexer.diagnostics().setLimit(limit);
+		size_t tokens = parallel ? lexer.tokenizeParallel(pool).size() : lexer.tokenizeAll().size();
+		size_t kept = lexer.diagnostics().size(), dropped = lexer.diagnostics().dropped();
+		std::vector<PL0::Diagnostic> records = lexer.diagnostics().drain();
+
+		bool ordered = std::is_sorted(records.begin(), records.end(),
+			[](const PL0::Diagnostic& a, const PL0::Diagnostic& b) { return a.offset < b.offset; });
+		bool same = tokens == errors && kept == std::min(limit, errors) && dropped == errors - kept && records.size() == kept
+			&& ordered && (records.empty() || records.front().offset == 0)
+			&& lexer.diagnostics().empty() && lexer.diagnostics().dropped() == 0;
+		std::cout << std::format("{}: {} errors, {} kept, {} dropped, {} drained{}\n", parallel ? "tokenizeParallel" : "tokenizeAll",
+			errors, kept, dropped, records.size(), same ? "" : ", WRONG");
+	}
+}
+
+// Lexes a generated program of `bytes` bytes, with an unknown symbol every 100 KB or so, from a file
+// through StreamLexer over an istream and over a file descriptor with windows far smaller than the
+// file, and checks that both give the tokens and errors of tokenizeAll on the whole text.
+void testStream(size_t bytes = 8'000'000)
+{
+	std::string text = generatedProgram(bytes);
+	for (size_t at = 1000; at < text.size(); at += 100'003)
+		text[at] = '$';
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "testStream.pl0";
+	std::ofstream(file, std::ios::binary) << text;
 
-	for (auto token = lexer.nextToken(); token.type != PL0::TokenType::ENDOFFILE; token = lexer.nextToken()) {
-		if (token.type == PL0::TokenType::KEYWORD) {
-			auto it = PL0::KeyWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+	PL0::Lexer whole(PL0::SourceText{ text });
+	PL0::TokenBuffer expected = whole.tokenizeAll();
+	auto check = [&](PL0::StreamLexer& lexer) {
+		size_t i = 0;
+		bool same = true;
+		for (PL0::TokenView token; (token = lexer.nextTokenView()).kind != PL0::TokenKind::ENDOFFILE; i++)
+		{
+			if (i >= expected.size())
+				return false;
+			PL0::TokenView wanted = expected[i];
+			same = same && token.kind == wanted.kind && token.offset == wanted.offset
+				&& token.length == wanted.length && token.number == wanted.number;
 		}
-		else if (token.type == PL0::TokenType::OPERATOR) {
-			auto it = PL0::OperatorWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+		return same && i == expected.size() && lexer.diagnostics().size() == whole.diagnostics().size();
+	};
+
+	for (size_t window : { size_t(256), size_t(1) << 16, PL0::StreamLexer::DefaultBufferSize })
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::ifstream in(file, std::ios::binary);
+		PL0::StreamLexer streamLexer(in, window);
+		bool streamSame = check(streamLexer);
+		std::chrono::duration<double, std::milli> streamTime = std::chrono::steady_clock::now() - start;
+
+		start = std::chrono::steady_clock::now();
+#ifdef _WIN32
+		int fd = _open(file.string().c_str(), _O_RDONLY | _O_BINARY);
+#else
+		int fd = open(file.string().c_str(), O_RDONLY);
+#endif
+		PL0::StreamLexer fdLexer(fd, window);
+		bool fdSame = check(fdLexer);
+#ifdef _WIN32
+		_close(fd);
+#else
+		close(fd);
+#endif
+		std::chrono::duration<double, std::milli> fdTime = std::chrono::steady_clock::now() - start;
+
+		std::cout << std::format("{:8} byte window: istream {:8.1f} ms {}, fd {:8.1f} ms {}\n", window,
+			streamTime.count(), streamSame ? "same" : "DIFFERENT", fdTime.count(), fdSame ? "same" : "DIFFERENT");
+	}
+	std::cout << std::format("{} bytes, {} tokens, {} errors\n", text.size(), expected.size(), whole.diagnostics().size());
+	std::filesystem::remove(file);
+}
+
+// Applies `edits` edits to a test3 expression of about `bytes` bytes through an IncrementalParser and
+// times them against re-lexing and re-parsing the whole text, which after every tenth edit also checks
+// the kept tokens and parse result. Most edits change a digit; every fourth one inserts a stray ')'
+// that the next one takes out again, so the parse keeps failing and recovering. A digit edit re-lexes
+// and re-parses a chunk or so, but as edits land anywhere it also moves the text gap by a third of the
+// text on average; a recovery parses on from the stray ')' to the end. The two are timed apart.
+void benchIncremental(size_t bytes = 10'000'000, size_t edits = 1000)
+{
+	std::string text = "a";
+	for (size_t i = 0; text.size() < bytes; i++)
+		text += std::format(" {} ({} * b)", i % 2 ? '+' : '-', i % 100);
+	std::filesystem::path file = std::filesystem::temp_directory_path() / "benchIncremental.pl0";
+	std::ofstream(file, std::ios::binary) << text;
+
+	auto start = std::chrono::steady_clock::now();
+	PL0::IncrementalParser parser(file.string(), "test/test3/rules.txt");
+	PL0::ParseResult result = parser.parse();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::format("{} bytes, {} tokens: first lex and parse {:8.1f} ms, {}\n",
+		text.size(), parser.lexer().tokenCount(), elapsed.count(), result.accepted ? "accepted" : result.message);
+
+	PL0::Grammar grammar("test/test3/rules.txt");
+	std::vector<PL0::GrammarSymbol> stack;
+	std::chrono::duration<double, std::micro> digits{}, strays{}, full{};
+	size_t checks = 0, mismatches = 0, stray = 0;
+	for (size_t i = 0; i < edits; i++)
+	{
+		size_t at = static_cast<size_t>(i * 2654435761u % text.size());
+		PL0::TextEdit edit;
+		if (i % 4 == 1)
+			edit = { stray = at, 0, ")" };
+		else if (i % 4 == 2)
+			edit = { stray, 1, "" };
+		else
+		{
+			size_t digit = text.find_first_of("0123456789", at);
+			digit = digit == std::string::npos ? text.find_first_of("0123456789") : digit;
+			edit = { digit, 1, std::string(1, static_cast<char>('0' + (text[digit] - '0' + 1) % 10)) };
 		}
-		else if (token.type == PL0::TokenType::DELIMITER) {
-			auto it = PL0::DelimiterWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+		text.replace(edit.offset, edit.removed, edit.inserted);
+
+		start = std::chrono::steady_clock::now();
+		result = parser.edit(edit);
+		(i % 4 == 1 || i % 4 == 2 ? strays : digits) += std::chrono::steady_clock::now() - start;
+		if (i % 10 != 9)
+			continue;
+
+		start = std::chrono::steady_clock::now();
+		PL0::Lexer lexer(PL0::SourceText{ text });
+		PL0::TokenBuffer expected = lexer.tokenizeAll();
+		PL0::ParseResult reparsed = PL0::BatchParser::parse(grammar, text, expected, stack);
+		full += std::chrono::steady_clock::now() - start;
+		checks++;
+
+		PL0::TokenBuffer tokens = parser.lexer().tokens();
+		bool same = tokens.kinds == expected.kinds && tokens.offsets == expected.offsets
+			&& tokens.lengths == expected.lengths && tokens.values == expected.values
+			&& result.accepted == reparsed.accepted && result.errorToken == reparsed.errorToken && result.message == reparsed.message;
+		mismatches += !same;
+	}
+	std::filesystem::remove(file);
+
+	size_t strayEdits = edits / 4 + (edits % 4 > 1) + edits / 4 + (edits % 4 > 2);
+	std::cout << std::format("{} edits: digit {:10.1f} us, stray ')' {:10.1f} us; full re-lex and re-parse {:10.1f} us{}\n",
+		edits, digits.count() / std::max<size_t>(edits - strayEdits, 1), strays.count() / std::max<size_t>(strayEdits, 1),
+		full.count() / std::max<size_t>(checks, 1),
+		mismatches == 0 ? "" : std::format(", {} of {} checks DIFFER", mismatches, checks));
+}
+
+// Times building the predict table for generated LL(1) grammars of growing size: 26 nonterminals,
+// each with `alternatives` rules led by a terminal of its own and closed by ';', and then either an
+// epsilon rule (every third one) or a chain rule three nonterminals on. Chains only run forwards and
+// skip the nullable nonterminals, so no two rules of a nonterminal predict the same terminal.
+void benchGrammar(size_t maxAlternatives = 64)
+{
+	constexpr size_t nonterminals = 26;
+	for (size_t alternatives = 1; alternatives <= maxAlternatives; alternatives *= 2)
+	{
+		std::vector<std::string> rules;
+		auto nonterminal = [](size_t k) { return std::format("n{}", k % nonterminals); };
+		for (size_t i = 0; i < nonterminals; i++)
+		{
+			for (size_t j = 0; j < alternatives; j++)
+				rules.push_back(std::format("{} -> t{}_{} {} {} ;", nonterminal(i), i, j, nonterminal(i + 1), nonterminal(i + 2)));
+			if (i % 3 == 0)
+				rules.push_back(nonterminal(i) + " ->");
+			else if (i + 3 < nonterminals)
+				rules.push_back(std::format("{} -> {}", nonterminal(i), nonterminal(i + 3)));
 		}
-		else if (token.type == PL0::TokenType::IDENTIFIER)
-			out << "(ident," << token.value << ")" << std::endl;
-		else if (token.type == PL0::TokenType::NUMBER)
-			out << "(number," << token.value << ")" << std::endl;
-		else if (token.type == PL0::TokenType::NONE)
-			out << "(error," << token.value << ")" << std::endl;
+		// Listed backwards, so information has to flow against the rule order.
+		std::reverse(rules.begin(), rules.end());
+
+		size_t count = rules.size();
+		auto start = std::chrono::steady_clock::now();
+		PL0::Grammar grammar(std::move(rules));
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << std::format("{:6} rules: {:10.1f} us\n", count, elapsed.count());
 	}
-	out.close();
+}
 
-	std::string rules = "test/test3/rules.txt";
-	PL0::LL1Parser Parser("test/test3/temp.txt",rules);
-	std::remove("test/test3/temp.txt");
-	Parser.getOriginFile(infile);
-	Parser.m_grammar.printPredictTable();
-	Parser.parse();
-};
+// Times building the predict table for named grammars with hundreds of symbols and compares the
+// row-displaced table with a dense nonterminals x symbols one. Each nonterminal has four rules led
+// by terminals spread over a pool as large as the nonterminal count; every fourth one also chains
+// to the next nonterminal, so rows hold four or eight entries out of hundreds of columns.
+void benchNamedGrammar(size_t maxNonterminals = 512)
+{
+	for (size_t nonterminals = 64; nonterminals <= maxNonterminals; nonterminals *= 2)
+	{
+		std::vector<std::string> rules;
+		auto nonterminal = [&](size_t k) { return std::format("n{}", k % nonterminals); };
+		for (size_t i = 0; i < nonterminals; i++)
+		{
+			for (size_t j = 0; j < 4; j++)
+				rules.push_back(std::format("{} -> t{} {}", nonterminal(i), (i * 7 + j * 13) % nonterminals, nonterminal(i + 1)));
+			if (i % 4 == 0)
+				rules.push_back(std::format("{} -> {}", nonterminal(i), nonterminal(i + 1)));
+		}
 
-void test4(std::string infile, std::string outaddress) 
+		size_t count = rules.size();
+		auto start = std::chrono::steady_clock::now();
+		PL0::Grammar grammar(std::move(rules));
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+		size_t dense = grammar.m_Vn.size() * grammar.m_symbols.size() * sizeof(std::int16_t);
+		size_t displaced = grammar.m_entries.size() * sizeof(PL0::PredictEntry) + grammar.m_base.size() * sizeof(std::int32_t);
+		std::cout << std::format("{:6} rules, {:5} symbols: {:10.1f} us, table {:8} bytes (dense {:8})\n",
+			count, grammar.m_symbols.size(), elapsed.count(), displaced, dense);
+	}
+}
+
+// Times semanticParse with the test4 grammar on "1 + 1 * 1 - 1 / 1 + ..." with `operators` operators;
+// every group of four adds nothing, so the value stays 1. The second run binds the operators to
+// lambdas that also count what they did, in place of the built-in actions.
+void benchSemantic(size_t operators = 1000000)
+{
+	std::string text = "1";
+	for (size_t i = 0; i < operators / 4; i++)
+		text += " + 1 * 1 - 1 / 1";
+	PL0::Lexer lexer(PL0::SourceText{ text });
+	PL0::TokenBuffer tokens = lexer.tokenizeAll();
+
+	PL0::LL1Parser Parser("test/test4/rules.txt");
+	Parser.getL_sdtFile("test/test4/L-SDT.txt");
+	auto start = std::chrono::steady_clock::now();
+	Parser.semanticParse(lexer, tokens);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::format("{} tokens, built-in actions: {:10.1f} ms\n", tokens.size(), elapsed.count());
+
+	size_t counts[4] = {};
+	Parser.m_registry.bind(3, [&](const PL0::ActionContext& context) { counts[0]++; return context.value + context.operand; }, true);
+	Parser.m_registry.bind(5, [&](const PL0::ActionContext& context) { counts[1]++; return context.value - context.operand; }, true);
+	Parser.m_registry.bind(10, [&](const PL0::ActionContext& context) { counts[2]++; return context.value * context.operand; }, true);
+	Parser.m_registry.bind(12, [&](const PL0::ActionContext& context) { counts[3]++; return context.value / context.operand; }, true);
+	start = std::chrono::steady_clock::now();
+	Parser.semanticParse(lexer, tokens);
+	elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::format("{} tokens, counting actions: {:10.1f} ms ({} +, {} -, {} *, {} /)\n",
+		tokens.size(), elapsed.count(), counts[0], counts[1], counts[2], counts[3]);
+}
+
+// Builds the AST of a test4 expression once, then evaluates it, prints it and lowers it to quadruples.
+void testAst(std::string infile)
 {
 	PL0::Lexer lexer(infile);
-	std::ofstream out("test/test4/temp.txt");
+	PL0::LL1Parser Parser("test/test4/rules.txt");
+	Parser.getL_sdtFile("test/test4/L-SDT.txt");
+
+	PL0::Ast ast;
+	PL0::AstIndex root = Parser.buildAst(lexer, ast);
+	lexer.printDiagnostics();
+	if (root == PL0::Ast::NoNode)
+		return;
 
-	for (auto token = lexer.nextToken(); token.type != PL0::TokenType::ENDOFFILE; token = lexer.nextToken()) {
-		if (token.type == PL0::TokenType::KEYWORD) {
-			auto it = PL0::KeyWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+	ast.print(std::cout, root);
+	std::cout << std::endl;
+	std::optional<std::int64_t> value = ast.evaluate(root);
+	std::cout << (value ? std::to_string(*value) : std::string("Error: Division by zero or integer overflow")) << std::endl;
+
+	PL0::Interner names;
+	std::vector<PL0::Quadruple> quadruples;
+	ast.quadruples(root, names, quadruples);
+	for (auto& quad : quadruples)
+		std::cout << std::format("{},{},{},{}\n", names.name(quad.op), names.name(quad.arg1), names.name(quad.arg2), names.name(quad.result));
+}
+
+// Times building the AST of the benchSemantic expression into one reused Ast, and evaluating it
+// `evaluations` times, against evaluating by parsing again each time.
+void benchAst(size_t operators = 1000000, size_t evaluations = 10)
+{
+	std::string text = "1";
+	for (size_t i = 0; i < operators / 4; i++)
+		text += " + 1 * 1 - 1 / 1";
+	PL0::Lexer lexer(PL0::SourceText{ text });
+	PL0::TokenBuffer tokens = lexer.tokenizeAll();
+
+	PL0::LL1Parser Parser("test/test4/rules.txt");
+	Parser.getL_sdtFile("test/test4/L-SDT.txt");
+	PL0::Ast ast;
+	PL0::AstIndex root = PL0::Ast::NoNode;
+	for (int round = 1; round <= 2; round++)
+	{
+		ast.clear();
+		auto start = std::chrono::steady_clock::now();
+		root = Parser.buildAst(lexer, tokens, ast);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << std::format("build #{}: {:10.1f} ms, {} nodes\n", round, elapsed.count(), ast.size());
+	}
+
+	std::optional<std::int64_t> value;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < evaluations; i++)
+		value = ast.evaluate(root);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::format("{} evaluations of the AST: {:10.1f} ms, value {}\n", evaluations, elapsed.count(), value ? *value : 0);
+
+	start = std::chrono::steady_clock::now();
+	std::int64_t value2 = 0;
+	for (size_t i = 0; i < evaluations; i++)
+	{
+		Parser.attach(lexer, tokens);
+		Parser.translate(value2);
+	}
+	elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::format("{} evaluations by reparsing: {:10.1f} ms, value {}\n", evaluations, elapsed.count(), value2);
+}
+
+// Counts predict/push steps per second over a test3 expression of `operators` operators, through
+// Grammar::step on the row-displaced table and through a reference in the old style, a std::map
+// from (nonterminal, terminal) to a copied right side. Both must take the same number of steps.
+void benchPredict(size_t operators = 1'000'000)
+{
+	std::string text = "a";
+	for (size_t i = 0; i < operators / 2; i++)
+		text += std::format(" {} ({} * b)", i % 2 ? '+' : '-', i % 100);
+	PL0::Lexer lexer(PL0::SourceText{ text });
+	PL0::TokenBuffer tokens = lexer.tokenizeAll();
+	PL0::Grammar grammar("test/test3/rules.txt");
+	std::vector<PL0::GrammarSymbol> input;
+	for (PL0::TokenKind kind : tokens.kinds)
+		input.push_back(grammar.symbolOf(kind));
+	input.push_back(grammar.m_endMarker);
+
+	std::vector<PL0::GrammarSymbol> stack;
+	auto start = std::chrono::steady_clock::now();
+	size_t steps = 0, next = 0;
+	stack = { grammar.m_endMarker, 0 };
+	for (PL0::ParseStep step = PL0::ParseStep::MATCH; step == PL0::ParseStep::MATCH || step == PL0::ParseStep::EXPAND; steps++)
+	{
+		int rule = 0;
+		step = grammar.step(stack, input[next], rule);
+		next += step == PL0::ParseStep::MATCH;
+	}
+	std::chrono::duration<double> table = std::chrono::steady_clock::now() - start;
+
+	std::map<std::pair<PL0::GrammarSymbol, PL0::GrammarSymbol>, std::vector<PL0::GrammarSymbol>> predict;
+	for (PL0::GrammarSymbol left = 0; left < grammar.m_Vn.size(); left++)
+		for (PL0::GrammarSymbol symbol = 0; symbol < grammar.m_symbols.size(); symbol++)
+			if (int rule = grammar.predict(left, symbol); rule != PL0::Grammar::NoProduction)
+				predict[{ left, symbol }].assign(grammar.pushSymbols(rule).begin(), grammar.pushSymbols(rule).end());
+	start = std::chrono::steady_clock::now();
+	size_t mapSteps = 0;
+	next = 0;
+	stack = { grammar.m_endMarker, 0 };
+	for (; ; mapSteps++)
+	{
+		PL0::GrammarSymbol top = stack.back();
+		if (top == grammar.m_endMarker)
+		{
+			mapSteps++;
+			break;
 		}
-		else if (token.type == PL0::TokenType::OPERATOR) {
-			auto it = PL0::OperatorWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+		if (top == input[next])
+		{
+			stack.pop_back();
+			next++;
+			continue;
 		}
-		else if (token.type == PL0::TokenType::DELIMITER) {
-			auto it = PL0::DelimiterWords.find(token.value);
-			out << "(" << it->second << "," << token.value << ")" << std::endl;
+		auto found = predict.find({ top, input[next] });
+		if (!grammar.isNonterminal(top) || found == predict.end())
+		{
+			mapSteps++;
+			break;
 		}
-		else if (token.type == PL0::TokenType::IDENTIFIER)
-			out << "(ident," << token.value << ")" << std::endl;
-		else if (token.type == PL0::TokenType::NUMBER)
-			out << "(number," << token.value << ")" << std::endl;
-		else if (token.type == PL0::TokenType::NONE)
-			out << "(error," << token.value << ")" << std::endl;
+		std::vector<PL0::GrammarSymbol> right = found->second;
+		stack.pop_back();
+		stack.insert(stack.end(), right.begin(), right.end());
 	}
-	out.close();
+	std::chrono::duration<double> map = std::chrono::steady_clock::now() - start;
 
-	std::string rules = "test/test4/rules.txt";
-	PL0::LL1Parser Parser("test/test4/temp.txt", rules);
-	std::remove("test/test4/temp.txt");
+	std::cout << std::format("{} tokens, {} steps: table {:8.1f} ms ({:6.1f} M steps/s), map {:8.1f} ms ({:6.1f} M steps/s){}\n",
+		tokens.size(), steps, table.count() * 1000, steps / table.count() / 1e6, map.count() * 1000, mapSteps / map.count() / 1e6,
+		steps == mapSteps ? "" : ", step counts DIFFER");
+}
 
-	std::string L_SDT="test/test4/L-SDT.txt";
-	Parser.getL_sdtFile(L_SDT);
-	//Parser.parse();
-	Parser.semanticParse();
+// Recognises 50000 generated expressions against one shared test3 grammar with 1, 2, 4, ... threads
+// up to the core count, and checks every thread count gives the same answers.
+void benchBatch(size_t inputs = 50000)
+{
+	auto grammar = std::make_shared<const PL0::Grammar>("test/test3/rules.txt");
+	std::vector<std::string> sources;
+	for (size_t i = 0; i < inputs; i++)
+	{
+		std::string text = "a";
+		for (size_t j = 0; j < i % 40; j++)
+			text += std::format(" {} ({} * b{})", j % 2 ? '+' : '-', j, i % 13);
+		// Every hundredth input is left unbalanced, so failures are exercised too.
+		sources.push_back(i % 100 == 99 ? text + ")" : text);
+	}
 
-};
+	std::vector<PL0::ParseResult> expected;
+	size_t cores = std::max(1u, std::thread::hardware_concurrency());
+	for (size_t threads = 1; ; threads = std::min(threads * 2, cores))
+	{
+		PL0::ThreadPool pool(threads);
+		PL0::BatchParser batch(grammar, pool);
+		auto start = std::chrono::steady_clock::now();
+		std::vector<PL0::ParseResult> results = batch.parseSources(sources);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		size_t accepted = std::count_if(results.begin(), results.end(), [](const PL0::ParseResult& result) { return result.accepted; });
+		if (expected.empty())
+			expected = results;
+		bool same = std::equal(results.begin(), results.end(), expected.begin(), [](const PL0::ParseResult& a, const PL0::ParseResult& b) {
+			return a.accepted == b.accepted && a.errorToken == b.errorToken && a.message == b.message;
+		});
+		std::cout << std::format("{:3} threads: {:10.1f} ms, {} of {} accepted{}\n",
+			threads, elapsed.count(), accepted, results.size(), same ? "" : ", DIFFERENT from 1 thread");
+		if (threads == cores)
+			break;
+	}
+}
+
+// Parses a whole PL/0 program with the grammar in test/pl0/rules.txt, which names its symbols.
+void testPL0(std::string infile)
+{
+	PL0::Lexer lexer(infile);
+
+	std::string rules = "test/pl0/rules.txt";
+	PL0::LL1Parser Parser(rules);
+	Parser.parse(lexer);
+	lexer.printDiagnostics();
+}
+
+// Regenerates the recursive-descent parsers in generated/ from the test3 and test4 grammars.
+void generateParsers()
+{
+	std::filesystem::create_directories("generated");
+
+	PL0::ParserGenerator recognizer("test/test3/rules.txt");
+	std::ofstream recognizerFile("generated/ExpressionRecognizer.hpp");
+	recognizer.emit(recognizerFile, "ExpressionRecognizer");
+
+	PL0::ParserGenerator evaluator("test/test4/rules.txt", "test/test4/L-SDT.txt");
+	std::ofstream evaluatorFile("generated/ExpressionEvaluator.hpp");
+	evaluator.emit(evaluatorFile, "ExpressionEvaluator");
+}
 
 void test6(std::string infile, std::string outaddress) {
 	std::ifstream in(infile);
 	//std::ofstream out(outaddress);
 
 	std::string line;
+	PL0::Interner names;
 	std::vector<PL0::Quadruple> inputQuadruples;
 	while (std::getline(in, line)) {
 		std::vector<std::string> quadItmes = PL0::split(line, ',');
 		PL0::Quadruple quad;
-		quad.op = quadItmes.at(0);
-		quad.arg1 = quadItmes.at(1);
-		quad.arg2 = quadItmes.at(2) == " " ? "" : quadItmes.at(2);
-		quad.result = quadItmes.at(3);
+		quad.op = names.intern(quadItmes.at(0));
+		quad.arg1 = names.intern(quadItmes.at(1));
+		quad.arg2 = quadItmes.at(2) == " " ? PL0::Interner::Empty : names.intern(quadItmes.at(2));
+		quad.result = names.intern(quadItmes.at(3));
 		inputQuadruples.push_back(quad);
 	}
 
-	PL0::Optimizer optimizer;
+	PL0::Optimizer optimizer(names);
 	optimizer.buildDAG(inputQuadruples);
 
 	auto resultQuadruples = optimizer.colloectQuadruples();
 	for (auto& quad : resultQuadruples) {
-		std::cout << std::format("{}, {}, {}, {}\n", quad.op, quad.arg1, quad.arg2, quad.result);
+		std::cout << std::format("{}, {}, {}, {}\n", names.name(quad.op), names.name(quad.arg1),
+			names.name(quad.arg2), names.name(quad.result));
 	}
 
 	//out.close();
@@ -0,0 +1,63 @@
+#include "ActionRegistry.hpp"
+#include "Exceptions.hpp"
+
+namespace PL0
+{
+	void ActionRegistry::bind(std::uint16_t number, Function function, bool binary)
+	{
+		if (number >= m_bindings.size())
+			m_bindings.resize(number + 1);
+		m_bindings[number] = { std::move(function), binary, std::nullopt };
+	}
+
+	namespace
+	{
+		template <BuiltinAction Action>
+		std::int64_t checked(const ActionContext& context)
+		{
+			if (Action == BuiltinAction::DIV && context.operand == 0)
+				throw ActionFailed("Division by zero");
+			std::optional<std::int64_t> result = evaluateBuiltin(Action, context.value, context.operand);
+			if (!result)
+				throw ActionFailed("Integer overflow");
+			return *result;
+		}
+	}
+
+	void ActionRegistry::bind(std::uint16_t number, BuiltinAction action)
+	{
+		switch (action)
+		{
+		case BuiltinAction::COPY:
+			bind(number, [](const ActionContext& context) { return context.value; });
+			break;
+		case BuiltinAction::ADD:
+			bind(number, checked<BuiltinAction::ADD>, true);
+			break;
+		case BuiltinAction::SUB:
+			bind(number, checked<BuiltinAction::SUB>, true);
+			break;
+		case BuiltinAction::MUL:
+			bind(number, checked<BuiltinAction::MUL>, true);
+			break;
+		case BuiltinAction::DIV:
+			bind(number, checked<BuiltinAction::DIV>, true);
+			break;
+		}
+		m_bindings[number].builtin = action;
+	}
+
+	ActionRegistry ActionRegistry::expression()
+	{
+		// The scheme of test/test4/L-SDT.txt: E->T{1}G{2}, G->+T{3}G{4}, G->-T{5}G{6}, G->e{7},
+		// T->F{8}S{9}, S->*F{10}S{11}, S->/F{12}S{13}, S->e{14}, F->n{15}, F->(E{16}){17}.
+		ActionRegistry registry;
+		for (std::uint16_t number = 1; number <= 17; number++)
+			registry.bind(number, BuiltinAction::COPY);
+		registry.bind(3, BuiltinAction::ADD);
+		registry.bind(5, BuiltinAction::SUB);
+		registry.bind(10, BuiltinAction::MUL);
+		registry.bind(12, BuiltinAction::DIV);
+		return registry;
+	}
+}
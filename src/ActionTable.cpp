@@ -0,0 +1,86 @@
+#include "ActionTable.hpp"
+#include "LL1Parser.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+
+namespace PL0
+{
+	ActionTable::ActionTable(const Grammar& grammar)
+	{
+		m_start.reserve(grammar.m_Rules.size() + 1);
+		for (size_t rule = 0; rule < grammar.m_Rules.size(); rule++)
+		{
+			m_start.push_back(static_cast<std::uint32_t>(m_actions.size()));
+			m_actions.resize(m_actions.size() + std::max<size_t>(1, grammar.pushSymbols(static_cast<int>(rule)).size()), None);
+		}
+		m_start.push_back(static_cast<std::uint32_t>(m_actions.size()));
+	}
+
+	void ActionTable::read(const Grammar& grammar, const std::string& filename)
+	{
+		std::ifstream file(filename);
+		if (!file.is_open())
+			throw OpenFileFailed(filename);
+		read(grammar, file);
+	}
+
+	void ActionTable::read(const Grammar& grammar, std::istream& lsdt)
+	{
+		// A new file replaces the actions of the last one rather than adding to them.
+		if (ruleCount() != grammar.m_Rules.size())
+			*this = ActionTable(grammar);
+		else
+		{
+			std::fill(m_actions.begin(), m_actions.end(), None);
+			m_count = 0;
+		}
+
+		// Strip the "{n}" marks to find the rule, remembering how many right-side symbols precede each.
+		std::string line, rule;
+		std::vector<std::pair<size_t, std::uint16_t>> marks;
+		while (std::getline(lsdt, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (line.size() < 3)
+				continue;
+
+			rule.clear();
+			marks.clear();
+			for (size_t i = 0; i < line.size(); i++)
+			{
+				if (line[i] != '{')
+				{
+					rule += line[i];
+					continue;
+				}
+				size_t close = line.find('}', i);
+				unsigned number = 0;
+				auto [end, error] = std::from_chars(line.data() + i + 1, line.data() + (close == std::string::npos ? i + 1 : close), number);
+				if (close == std::string::npos || rule.find("->") == std::string::npos || error != std::errc()
+					|| end != line.data() + close || number == None || number > UINT16_MAX)
+					throw UnMatched(line);
+				marks.push_back({ grammar.symbolCount(rule), static_cast<std::uint16_t>(number) });
+				i = close;
+			}
+
+			int index = grammar.ruleOf(rule);
+			if (index == Grammar::NoProduction)
+				throw UnMatched(line);
+			size_t symbols = grammar.pushSymbols(index).size();
+			for (auto [count, number] : marks)
+			{
+				// An empty right side has one slot; otherwise an action must follow a symbol.
+				if (count == 0 && symbols != 0)
+					throw UnMatched(line);
+				std::uint16_t& slot = m_actions[m_start[index] + (count == 0 ? 0 : count - 1)];
+				if (slot != None)
+					throw UnMatched(line);
+				m_count++;
+				slot = number;
+			}
+		}
+	}
+}
@@ -0,0 +1,177 @@
+#include "Ast.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <string>
+
+namespace PL0
+{
+	namespace
+	{
+		constexpr const char* spellingOf(AstOp op)
+		{
+			switch (op)
+			{
+			case AstOp::ADD: return "+";
+			case AstOp::SUB: return "-";
+			case AstOp::MUL: return "*";
+			case AstOp::DIV: return "/";
+			default: return "";
+			}
+		}
+	}
+
+	AstIndex Ast::number(std::int64_t value)
+	{
+		AstIndex index = static_cast<AstIndex>(m_nodes.size());
+		m_nodes.push_back({ AstOp::NUMBER, static_cast<AstIndex>(m_literals.size()), NoNode, index });
+		m_literals.push_back(value);
+		return index;
+	}
+
+	AstIndex Ast::binary(AstOp op, AstIndex left, AstIndex right)
+	{
+		if (!contains(left) || !contains(right))
+			throw InvalidNode(contains(left) ? right : left, m_nodes.size());
+		AstIndex index = static_cast<AstIndex>(m_nodes.size());
+		m_nodes.push_back({ op, left, right, std::min(m_nodes[left].first, m_nodes[right].first) });
+		return index;
+	}
+
+	void Ast::mark(AstIndex root) const
+	{
+		// Other trees may be interleaved with this one; mark what is reachable from the root.
+		AstIndex first = m_nodes[root].first;
+		m_inTree.assign(static_cast<size_t>(root - first) + 1, 0);
+		m_inTree[root - first] = 1;
+		for (AstIndex i = root; i >= first; i--)
+		{
+			const AstNode& node = m_nodes[i];
+			if (m_inTree[i - first] && node.op != AstOp::NUMBER)
+				m_inTree[node.left - first] = m_inTree[node.right - first] = 1;
+		}
+	}
+
+	std::optional<std::int64_t> Ast::evaluate(AstIndex root) const
+	{
+		if (!contains(root))
+			return std::nullopt;
+
+		// Children come before their parent, so one forward sweep over the subtree is enough.
+		mark(root);
+		AstIndex first = m_nodes[root].first;
+		m_values.resize(static_cast<size_t>(root - first) + 1);
+		for (AstIndex i = first; i <= root; i++)
+		{
+			const AstNode& node = m_nodes[i];
+			if (!m_inTree[i - first])
+				continue;
+			if (node.op == AstOp::NUMBER)
+			{
+				m_values[i - first] = literal(node);
+				continue;
+			}
+			BuiltinAction action = node.op == AstOp::ADD ? BuiltinAction::ADD : node.op == AstOp::SUB ? BuiltinAction::SUB
+				: node.op == AstOp::MUL ? BuiltinAction::MUL : BuiltinAction::DIV;
+			std::optional<std::int64_t> value = evaluateBuiltin(action, m_values[node.left - first], m_values[node.right - first]);
+			if (!value)
+				return std::nullopt;
+			m_values[i - first] = *value;
+		}
+		return m_values[root - first];
+	}
+
+	void Ast::print(std::ostream& out, AstIndex root) const
+	{
+		if (!contains(root))
+			return;
+		// Fully parenthesised infix. Stage 0 opens a node, 1 prints its operator, 2 closes it.
+		m_walk.clear();
+		m_walk.push_back({ root, 0 });
+		while (!m_walk.empty())
+		{
+			auto& [index, stage] = m_walk.back();
+			const AstNode& node = m_nodes[index];
+			if (node.op == AstOp::NUMBER)
+			{
+				out << literal(node);
+				m_walk.pop_back();
+			}
+			else if (stage == 0)
+			{
+				out << '(';
+				stage = 1;
+				m_walk.push_back({ node.left, 0 });
+			}
+			else if (stage == 1)
+			{
+				out << ' ' << spellingOf(node.op) << ' ';
+				stage = 2;
+				m_walk.push_back({ node.right, 0 });
+			}
+			else
+			{
+				out << ')';
+				m_walk.pop_back();
+			}
+		}
+	}
+
+	SymbolId Ast::quadruples(AstIndex root, Interner& names, std::vector<Quadruple>& out) const
+	{
+		if (!contains(root))
+			return Interner::Empty;
+
+		// Same sweep as evaluate, naming each operator's result T1, T2, ... in the order computed.
+		mark(root);
+		AstIndex first = m_nodes[root].first;
+		m_operands.resize(static_cast<size_t>(root - first) + 1);
+		size_t temporaries = 0;
+		for (AstIndex i = first; i <= root; i++)
+		{
+			const AstNode& node = m_nodes[i];
+			if (!m_inTree[i - first])
+				continue;
+			if (node.op == AstOp::NUMBER)
+			{
+				m_operands[i - first] = names.intern(std::to_string(literal(node)));
+				continue;
+			}
+			SymbolId result = names.intern("T" + std::to_string(++temporaries));
+			out.emplace_back(names.intern(spellingOf(node.op)), m_operands[node.left - first], m_operands[node.right - first], result);
+			m_operands[i - first] = result;
+		}
+		return m_operands[root - first];
+	}
+
+	ActionRegistry Ast::actions(const ActionRegistry& scheme)
+	{
+		if (scheme.numberBound())
+			throw NotImmeplemented("AST node for a bound number action");
+		ActionRegistry registry;
+		registry.bindNumber([this](const ActionContext& context) { return number(context.value); });
+		for (std::uint16_t action = 1; action < scheme.size(); action++)
+		{
+			std::optional<BuiltinAction> builtin = scheme.builtin(action);
+			if (!builtin)
+			{
+				if (scheme.bound(action))
+					throw NotImmeplemented("AST node for action {" + std::to_string(action) + "}");
+				continue;
+			}
+
+			AstOp op;
+			switch (*builtin)
+			{
+			case BuiltinAction::COPY:
+				registry.bind(action, BuiltinAction::COPY);
+				continue;
+			case BuiltinAction::ADD: op = AstOp::ADD; break;
+			case BuiltinAction::SUB: op = AstOp::SUB; break;
+			case BuiltinAction::MUL: op = AstOp::MUL; break;
+			default: op = AstOp::DIV; break;
+			}
+			registry.bind(action, [this, op](const ActionContext& context) { return binary(op, static_cast<AstIndex>(context.value), static_cast<AstIndex>(context.operand)); }, true);
+		}
+		return registry;
+	}
+}
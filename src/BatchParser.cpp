@@ -0,0 +1,71 @@
+#include "BatchParser.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace PL0
+{
+	BatchParser::BatchParser(std::shared_ptr<const Grammar> grammar, ThreadPool& pool)
+		: m_grammar(std::move(grammar)), m_pool(pool)
+	{
+	}
+
+	std::vector<ParseResult> BatchParser::parseFiles(const std::vector<std::string>& files)
+	{
+		return run(files.size(), [&files](size_t i) { return Lexer(files[i]); });
+	}
+
+	std::vector<ParseResult> BatchParser::parseSources(const std::vector<std::string>& sources)
+	{
+		return run(sources.size(), [&sources](size_t i) { return Lexer(SourceText{ sources[i] }); });
+	}
+
+	template <typename MakeLexer>
+	std::vector<ParseResult> BatchParser::run(size_t count, MakeLexer makeLexer)
+	{
+		std::vector<ParseResult> results(count);
+		std::atomic<size_t> next = 0;
+		// forEach runs tasks on the workers and on the calling thread, so one more than the pool.
+		size_t taskCount = std::min(m_pool.size() + 1, count);
+
+		m_pool.forEach(taskCount, [this, &results, &next, &makeLexer, count](size_t) {
+			std::vector<GrammarSymbol> stack;
+			TokenBuffer tokens;
+			for (size_t i = next++; i < count; i = next++)
+			{
+				try
+				{
+					Lexer lexer = makeLexer(i);
+					tokens.clear();
+					lexer.nextTokens(tokens, std::numeric_limits<size_t>::max());
+					results[i] = parse(*m_grammar, lexer.source(), tokens, stack);
+				}
+				catch (const std::exception& error)
+				{
+					results[i] = { false, 0, error.what() };
+				}
+			}
+		});
+		return results;
+	}
+
+	ParseResult BatchParser::parse(const Grammar& grammar, std::string_view source, const TokenBuffer& tokens, std::vector<GrammarSymbol>& stack)
+	{
+		stack.assign({ grammar.m_endMarker, 0 });
+		size_t token = 0;
+		while (true)
+		{
+			TokenKind kind = token < tokens.size() ? tokens.kinds[token] : TokenKind::ENDOFFILE;
+			GrammarSymbol top = stack.back();
+			int rule = 0;
+			ParseStep step = grammar.step(stack, grammar.symbolOf(kind), rule);
+			if (step == ParseStep::MATCH)
+				token++;
+			else if (step != ParseStep::EXPAND)
+			{
+				std::string_view text = token < tokens.size() ? source.substr(tokens.offsets[token], tokens.lengths[token]) : "#";
+				return { step == ParseStep::ACCEPT, step == ParseStep::ACCEPT ? 0 : token, grammar.describe(step, top, text) };
+			}
+		}
+	}
+}
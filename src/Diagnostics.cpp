@@ -0,0 +1,86 @@
+#include "Diagnostics.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace PL0
+{
+	Diagnostics::Diagnostics(size_t limit)
+		: m_limit(limit)
+	{
+	}
+
+	void Diagnostics::reserveFirst()
+	{
+		m_records.reserve(std::min<size_t>(m_limit, 256));
+	}
+
+	void Diagnostics::append(const Diagnostics& other, size_t shift)
+	{
+		size_t room = m_records.size() < m_limit ? m_limit - m_records.size() : 0;
+		size_t count = std::min(room, other.m_records.size());
+		for (size_t i = 0; i < count; i++)
+		{
+			m_records.push_back(other.m_records[i]);
+			m_records.back().offset += shift;
+		}
+		m_dropped += other.m_records.size() - count + other.m_dropped;
+	}
+
+	std::vector<Diagnostic> Diagnostics::drain()
+	{
+		std::vector<Diagnostic> records;
+		records.swap(m_records);
+		m_dropped = 0;
+		return records;
+	}
+
+	void Diagnostics::clear()
+	{
+		m_records.clear();
+		m_dropped = 0;
+	}
+
+	namespace
+	{
+		constexpr std::string_view MessageTails[] = {
+			" is not a valid identifier\n",
+			" is not a valid operator\n",
+			" is an unknown symbol\n",
+			" is too large a number\n"
+		};
+
+		void appendMessage(std::string& text, const Diagnostic& diagnostic, std::string_view spelling)
+		{
+			char digits[16];
+			auto [end, error] = std::to_chars(digits, digits + sizeof digits, diagnostic.line);
+			text += "Error: Line ";
+			text.append(digits, end);
+			text += ", ";
+			// Operators are printed as written; everything else lowercased, as identifiers are.
+			if (diagnostic.code == DiagnosticCode::INVALID_OPERATOR)
+				text += spelling;
+			else
+				for (unsigned char c : spelling)
+					text += static_cast<char>(std::tolower(c));
+			text += MessageTails[static_cast<size_t>(diagnostic.code)];
+		}
+	}
+
+	void Diagnostics::render(std::ostream& out, std::string_view source, size_t base) const
+	{
+		// `source` starts at offset `base` of the text the records point into.
+		std::string text;
+		text.reserve(m_records.size() * 48);
+		for (auto& record : m_records)
+			appendMessage(text, record, source.substr(record.offset - base, record.length));
+		out << text;
+	}
+
+	std::string Diagnostics::message(const Diagnostic& diagnostic, std::string_view spelling)
+	{
+		std::string text;
+		appendMessage(text, diagnostic, spelling);
+		return text;
+	}
+}
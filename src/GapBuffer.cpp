@@ -0,0 +1,72 @@
+#include "GapBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace PL0
+{
+	GapBuffer::GapBuffer(std::string_view text)
+		: m_buffer(text.size() + MinGap), m_gapStart(text.size()), m_gapEnd(text.size() + MinGap)
+	{
+		std::copy(text.begin(), text.end(), m_buffer.begin());
+	}
+
+	void GapBuffer::moveGap(size_t offset)
+	{
+		if (offset < m_gapStart)
+		{
+			size_t count = m_gapStart - offset;
+			std::memmove(m_buffer.data() + m_gapEnd - count, m_buffer.data() + offset, count);
+			m_gapStart -= count;
+			m_gapEnd -= count;
+		}
+		else if (offset > m_gapStart)
+		{
+			size_t count = offset - m_gapStart;
+			std::memmove(m_buffer.data() + m_gapStart, m_buffer.data() + m_gapEnd, count);
+			m_gapStart += count;
+			m_gapEnd += count;
+		}
+	}
+
+	void GapBuffer::replace(size_t offset, size_t removed, std::string_view inserted)
+	{
+		moveGap(offset);
+		m_gapEnd += removed;
+
+		if (inserted.size() > m_gapEnd - m_gapStart)
+		{
+			// Grow geometrically, so a run of insertions stays linear in what they add.
+			size_t after = m_buffer.size() - m_gapEnd;
+			size_t capacity = std::max(m_buffer.size() * 2, size() + inserted.size() + MinGap);
+			std::vector<char> grown(capacity);
+			std::copy(m_buffer.begin(), m_buffer.begin() + m_gapStart, grown.begin());
+			std::copy(m_buffer.end() - after, m_buffer.end(), grown.end() - after);
+			m_gapEnd = capacity - after;
+			m_buffer.swap(grown);
+		}
+
+		std::copy(inserted.begin(), inserted.end(), m_buffer.begin() + m_gapStart);
+		m_gapStart += inserted.size();
+	}
+
+	std::string_view GapBuffer::tail(size_t offset)
+	{
+		moveGap(offset);
+		return { m_buffer.data() + m_gapEnd, m_buffer.size() - m_gapEnd };
+	}
+
+	std::string GapBuffer::substr(size_t offset, size_t length) const
+	{
+		std::string text;
+		text.reserve(length);
+		size_t end = offset + length;
+		if (offset < m_gapStart)
+			text.append(m_buffer.data() + offset, std::min(end, m_gapStart) - offset);
+		if (end > m_gapStart)
+		{
+			size_t from = std::max(offset, m_gapStart);
+			text.append(m_buffer.data() + from + (m_gapEnd - m_gapStart), end - from);
+		}
+		return text;
+	}
+}
@@ -0,0 +1,234 @@
+#include "LL1Parser.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <random>
+
+namespace PL0
+{
+	namespace
+	{
+		constexpr char CacheMagic[8] = { 'P', 'L', '0', 'L', 'L', '1', 'T', 'B' };
+		constexpr std::uint32_t CacheVersion = 2;
+		constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+		struct CacheHeader
+		{
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t byteOrder;
+			std::uint64_t hash;
+			std::uint32_t ruleCount;
+			std::uint32_t vnCount;
+			std::uint32_t vtCount;
+			std::uint32_t symbolCount;
+			std::uint32_t nameBytes;
+			std::uint32_t rhsCount;
+			std::uint32_t entryCount;
+			std::uint32_t setWords;
+		};
+
+		std::uint64_t hashText(std::string_view text)
+		{
+			// FNV-1a
+			std::uint64_t h = 14695981039346656037ull;
+			for (unsigned char c : text)
+				h = (h ^ c) * 1099511628211ull;
+			return h;
+		}
+
+		template <typename T>
+		void putArray(std::string& out, const T* data, size_t count)
+		{
+			out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+		}
+
+		// Names go out as their lengths followed by their bytes.
+		void putNames(std::string& out, const std::vector<std::string>& names)
+		{
+			for (auto& name : names)
+			{
+				std::uint32_t length = static_cast<std::uint32_t>(name.size());
+				putArray(out, &length, 1);
+			}
+			for (auto& name : names)
+				out += name;
+		}
+
+		class CacheReader
+		{
+		public:
+			explicit CacheReader(std::string_view bytes) : m_bytes(bytes) {}
+
+			template <typename T>
+			bool read(T* data, size_t count)
+			{
+				size_t size = count * sizeof(T);
+				if (m_bytes.size() - m_pos < size)
+					return false;
+				std::memcpy(data, m_bytes.data() + m_pos, size);
+				m_pos += size;
+				return true;
+			}
+
+			bool readNames(std::vector<std::string>& names, size_t bytes)
+			{
+				std::vector<std::uint32_t> lengths(names.size());
+				if (!read(lengths.data(), lengths.size()) || m_bytes.size() - m_pos < bytes)
+					return false;
+				size_t total = 0;
+				for (size_t i = 0; i < names.size(); i++)
+				{
+					if (lengths[i] > bytes - total)
+						return false;
+					names[i].assign(m_bytes.substr(m_pos + total, lengths[i]));
+					total += lengths[i];
+				}
+				m_pos += bytes;
+				return total == bytes;
+			}
+
+			bool readSet(SymbolSet& set, size_t symbols)
+			{
+				set = SymbolSet(symbols);
+				return read(set.words().data(), set.words().size());
+			}
+
+			bool atEnd() const { return m_pos == m_bytes.size(); }
+
+		private:
+			std::string_view m_bytes;
+			size_t m_pos = 0;
+		};
+	}
+
+	bool Grammar::loadCache(const std::string& path, std::string_view rulesText)
+	{
+		MappedFile mapping;
+		try
+		{
+			mapping = MappedFile(path);
+		}
+		catch (const OpenFileFailed&)
+		{
+			return false;
+		}
+
+		CacheReader in(mapping.view());
+		CacheHeader header;
+		if (!in.read(&header, 1)
+			|| std::memcmp(header.magic, CacheMagic, sizeof CacheMagic) != 0
+			|| header.version != CacheVersion
+			|| header.byteOrder != ByteOrderMark
+			|| header.hash != hashText(rulesText)
+			|| header.ruleCount != m_Rules.size()
+			|| header.vnCount == 0
+			|| header.symbolCount >= NoSymbol
+			|| header.vnCount > header.symbolCount
+			|| header.setWords != SymbolSet(header.symbolCount).words().size())
+			return false;
+
+		// Anything inconsistent below means a stale or damaged file; the caller rebuilds and rewrites it.
+		std::vector<std::string> names(header.symbolCount + header.vtCount);
+		m_ruleLeft.resize(header.ruleCount);
+		m_rhsStart.resize(header.ruleCount + 1);
+		m_rhs.resize(header.rhsCount);
+		m_base.resize(header.vnCount);
+		m_entries.resize(header.entryCount);
+		m_First.resize(header.vnCount);
+		m_Follow.resize(header.vnCount);
+
+		bool ok = in.readNames(names, header.nameBytes)
+			&& in.read(m_ruleLeft.data(), m_ruleLeft.size())
+			&& in.read(m_rhsStart.data(), m_rhsStart.size())
+			&& in.read(m_rhs.data(), m_rhs.size())
+			&& in.read(m_base.data(), m_base.size())
+			&& in.read(m_entries.data(), m_entries.size())
+			&& in.readSet(m_nullable, header.symbolCount);
+		for (size_t i = 0; ok && i < header.vnCount; i++)
+			ok = in.readSet(m_First[i], header.symbolCount) && in.readSet(m_Follow[i], header.symbolCount);
+		if (ok)
+		{
+			m_symbols.assign(names.begin(), names.begin() + header.symbolCount);
+			m_Vn.assign(names.begin(), names.begin() + header.vnCount);
+			m_Vt.assign(names.begin() + header.symbolCount, names.end());
+		}
+		ok = ok && in.atEnd() && m_rhsStart.front() == 0 && m_rhsStart.back() == m_rhs.size()
+			&& std::is_sorted(m_rhsStart.begin(), m_rhsStart.end())
+			&& std::all_of(m_ruleLeft.begin(), m_ruleLeft.end(), [this](GrammarSymbol s) { return isNonterminal(s); })
+			&& std::all_of(m_rhs.begin(), m_rhs.end(), [this](GrammarSymbol s) { return s < m_symbols.size(); })
+			&& std::all_of(m_entries.begin(), m_entries.end(), [this](const PredictEntry& entry) {
+				return entry.owner == NoSymbol ? entry.rule == NoProduction : isNonterminal(entry.owner) && entry.rule >= 0 && entry.rule < int(m_Rules.size());
+			});
+		if (ok)
+		{
+			indexSymbols();
+			return true;
+		}
+
+		m_Vn.clear();
+		m_Vt.clear();
+		m_symbols.clear();
+		m_First.clear();
+		m_Follow.clear();
+		return false;
+	}
+
+	void Grammar::saveCache(const std::string& path, std::string_view rulesText) const
+	{
+		CacheHeader header{};
+		std::memcpy(header.magic, CacheMagic, sizeof CacheMagic);
+		header.version = CacheVersion;
+		header.byteOrder = ByteOrderMark;
+		header.hash = hashText(rulesText);
+		header.ruleCount = static_cast<std::uint32_t>(m_Rules.size());
+		header.vnCount = static_cast<std::uint32_t>(m_Vn.size());
+		header.vtCount = static_cast<std::uint32_t>(m_Vt.size());
+		header.symbolCount = static_cast<std::uint32_t>(m_symbols.size());
+		header.rhsCount = static_cast<std::uint32_t>(m_rhs.size());
+		header.entryCount = static_cast<std::uint32_t>(m_entries.size());
+		header.setWords = static_cast<std::uint32_t>(m_nullable.words().size());
+		for (auto& name : m_symbols)
+			header.nameBytes += static_cast<std::uint32_t>(name.size());
+		for (auto& name : m_Vt)
+			header.nameBytes += static_cast<std::uint32_t>(name.size());
+
+		// Vn is the front of the symbol list, so only the symbols and Vt are written.
+		std::string out;
+		putArray(out, &header, 1);
+		std::vector<std::string> names = m_symbols;
+		names.insert(names.end(), m_Vt.begin(), m_Vt.end());
+		putNames(out, names);
+		putArray(out, m_ruleLeft.data(), m_ruleLeft.size());
+		putArray(out, m_rhsStart.data(), m_rhsStart.size());
+		putArray(out, m_rhs.data(), m_rhs.size());
+		putArray(out, m_base.data(), m_base.size());
+		putArray(out, m_entries.data(), m_entries.size());
+		putArray(out, m_nullable.words().data(), m_nullable.words().size());
+		for (size_t i = 0; i < m_Vn.size(); i++)
+		{
+			putArray(out, m_First[i].words().data(), m_First[i].words().size());
+			putArray(out, m_Follow[i].words().data(), m_Follow[i].words().size());
+		}
+
+		// Write beside the target and rename over it, so a concurrent reader never sees half a file.
+		// Each writer gets its own temporary name, so processes saving the same cache do not write
+		// into one file. The cache is only an optimisation: failing to write it is not an error.
+		std::random_device entropy;
+		std::string temp = std::format("{}.{:08x}{:08x}.tmp", path, entropy(), entropy());
+		std::error_code error;
+		{
+			std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+			if (!file.write(out.data(), static_cast<std::streamsize>(out.size())))
+			{
+				file.close();
+				std::filesystem::remove(temp, error);
+				return;
+			}
+		}
+		std::filesystem::rename(temp, path, error);
+		if (error)
+			std::filesystem::remove(temp, error);
+	}
+}
@@ -0,0 +1,259 @@
+#include "IncrementalLexer.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace PL0
+{
+	void PrefixSums::assign(const std::vector<size_t>& values)
+	{
+		m_tree.assign(values.size() + 1, 0);
+		for (size_t i = 1; i <= values.size(); i++)
+		{
+			m_tree[i] += values[i - 1];
+			size_t parent = i + (i & (0 - i));
+			if (parent <= values.size())
+				m_tree[parent] += m_tree[i];
+		}
+	}
+
+	void PrefixSums::add(size_t i, std::ptrdiff_t delta)
+	{
+		// Unsigned wrap-around makes adding a negative delta exact.
+		for (size_t j = i + 1; j < m_tree.size(); j += j & (0 - j))
+			m_tree[j] += static_cast<size_t>(delta);
+	}
+
+	size_t PrefixSums::before(size_t i) const
+	{
+		size_t sum = 0;
+		for (size_t j = i; j > 0; j -= j & (0 - j))
+			sum += m_tree[j];
+		return sum;
+	}
+
+	size_t PrefixSums::find(size_t value) const
+	{
+		size_t pos = 0;
+		for (size_t step = std::bit_floor(size()); step > 0; step >>= 1)
+			if (pos + step <= size() && m_tree[pos + step] <= value)
+			{
+				pos += step;
+				value -= m_tree[pos];
+			}
+		return pos;
+	}
+
+	IncrementalLexer::IncrementalLexer(const std::string& filename)
+	{
+		Lexer file(filename);
+		build(file.source());
+	}
+
+	IncrementalLexer::IncrementalLexer(std::string_view text)
+	{
+		build(text);
+	}
+
+	void IncrementalLexer::build(std::string_view text)
+	{
+		m_text = GapBuffer(text);
+		Lexer lexer(SourceText{ text });
+		TokenBuffer tokens = lexer.tokenizeAll();
+		size_t count = std::max<size_t>(1, (tokens.size() + ChunkTokens - 1) / ChunkTokens);
+		m_chunks = split(text, 1, tokens, lexer.diagnostics().drain(), count);
+		reindex();
+	}
+
+	std::vector<TokenChunk> IncrementalLexer::split(std::string_view region, size_t firstLine, const TokenBuffer& tokens,
+		std::vector<Diagnostic> diagnostics, size_t count) const
+	{
+		// `tokens` and `diagnostics` are positioned from the start of `region`, which is on line
+		// `firstLine`. Errors past the region belong to tokens that are not part of it.
+		std::vector<TokenChunk> chunks(count);
+		size_t line = firstLine, error = 0;
+		for (size_t j = 0; j < count; j++)
+		{
+			size_t first = tokens.size() * j / count, last = tokens.size() * (j + 1) / count;
+			size_t start = j == 0 ? 0 : tokens.offsets[first];
+			size_t end = j + 1 == count ? region.size() : tokens.offsets[last];
+
+			TokenChunk& chunk = chunks[j];
+			chunk.bytes = end - start;
+			chunk.newlines = std::count(region.begin() + start, region.begin() + end, '\n');
+			chunk.tokens.reserve(last - first);
+			for (size_t i = first; i < last; i++)
+			{
+				TokenView token = tokens[i];
+				token.offset -= start;
+				chunk.tokens.push_back(token, tokens.values[i]);
+			}
+			for (; error < diagnostics.size() && diagnostics[error].offset < end; error++)
+			{
+				Diagnostic record = diagnostics[error];
+				record.offset -= start;
+				record.line -= static_cast<std::uint32_t>(line);
+				chunk.diagnostics.push_back(record);
+			}
+			line += chunk.newlines;
+		}
+		return chunks;
+	}
+
+	void IncrementalLexer::reindex()
+	{
+		std::vector<size_t> bytes(m_chunks.size()), newlines(m_chunks.size()), counts(m_chunks.size());
+		for (size_t k = 0; k < m_chunks.size(); k++)
+		{
+			bytes[k] = m_chunks[k].bytes;
+			newlines[k] = m_chunks[k].newlines;
+			counts[k] = m_chunks[k].tokens.size();
+		}
+		m_bytes.assign(bytes);
+		m_newlines.assign(newlines);
+		m_tokenCounts.assign(counts);
+	}
+
+	ChunkEdit IncrementalLexer::edit(const TextEdit& edit)
+	{
+		if (edit.offset > m_text.size() || edit.removed > m_text.size() - edit.offset)
+			throw InvalidEdit(edit.offset, edit.removed, m_text.size());
+		if (m_text.size() - edit.removed + edit.inserted.size() > std::numeric_limits<std::uint32_t>::max())
+			throw InputTooLarge("token buffer");
+
+		// Restart at the start of a chunk that lies before the edit: the tokens before it end
+		// before the edit, so neither they nor the token starting there can have merged with it.
+		size_t a = std::min(m_bytes.find(edit.offset), m_chunks.size() - 1);
+		while (a > 0 && chunkStart(a) >= edit.offset)
+			a--;
+		size_t start = chunkStart(a);
+		size_t firstLine = 1 + m_newlines.before(a);
+		size_t oldEnd = edit.offset + edit.removed;
+
+		m_text.replace(edit.offset, edit.removed, edit.inserted);
+		std::string_view rest = m_text.tail(start);
+
+		// Once a new token starts on an old chunk boundary past the edit (moved by the size change),
+		// the text from there on is unchanged, and so are that chunk and all after it.
+		Lexer lexer(SourceText{ rest, firstLine });
+		TokenBuffer fresh;
+		size_t b = a + 1, boundary = start + m_chunks[a].bytes, end = rest.size();
+		while (true)
+		{
+			TokenView token = lexer.nextTokenView();
+			if (token.kind == TokenKind::ENDOFFILE)
+			{
+				b = m_chunks.size();
+				break;
+			}
+
+			size_t at = start + token.offset;
+			while (b < m_chunks.size() && (boundary < oldEnd || boundary - edit.removed + edit.inserted.size() < at))
+				boundary += m_chunks[b++].bytes;
+			if (b < m_chunks.size() && boundary - edit.removed + edit.inserted.size() == at)
+			{
+				end = token.offset;
+				break;
+			}
+			fresh.push_back(token, token.kind == TokenKind::NUMBER ? token.number : 0);
+		}
+
+		std::string_view region = rest.substr(0, end);
+		size_t removed = b - a;
+		std::ptrdiff_t tokenDelta = static_cast<std::ptrdiff_t>(fresh.size())
+			- static_cast<std::ptrdiff_t>(m_tokenCounts.before(b) - m_tokenCounts.before(a));
+
+		// Keep the chunk count when the sizes allow, so the sums take point updates; otherwise
+		// split the region afresh. A region without tokens joins the chunk before it.
+		size_t inserted;
+		if (fresh.empty())
+			inserted = a == 0 ? 1 : 0;
+		else if (fresh.size() >= removed * ChunkTokens / 4 && fresh.size() <= removed * ChunkTokens * 2)
+			inserted = removed;
+		else
+			inserted = (fresh.size() + ChunkTokens - 1) / ChunkTokens;
+
+		if (inserted == 0)
+		{
+			TokenChunk& previous = m_chunks[a - 1];
+			previous.bytes += region.size();
+			previous.newlines += std::count(region.begin(), region.end(), '\n');
+			m_chunks.erase(m_chunks.begin() + a, m_chunks.begin() + b);
+			reindex();
+			return { a, removed, 0, tokenDelta };
+		}
+
+		std::vector<TokenChunk> chunks = split(region, firstLine, fresh, lexer.diagnostics().drain(), inserted);
+		if (inserted == removed)
+		{
+			for (size_t j = 0; j < inserted; j++)
+			{
+				TokenChunk& old = m_chunks[a + j];
+				m_bytes.add(a + j, static_cast<std::ptrdiff_t>(chunks[j].bytes) - static_cast<std::ptrdiff_t>(old.bytes));
+				m_newlines.add(a + j, static_cast<std::ptrdiff_t>(chunks[j].newlines) - static_cast<std::ptrdiff_t>(old.newlines));
+				m_tokenCounts.add(a + j, static_cast<std::ptrdiff_t>(chunks[j].tokens.size()) - static_cast<std::ptrdiff_t>(old.tokens.size()));
+				old = std::move(chunks[j]);
+			}
+		}
+		else
+		{
+			m_chunks.erase(m_chunks.begin() + a, m_chunks.begin() + b);
+			m_chunks.insert(m_chunks.begin() + a, std::make_move_iterator(chunks.begin()), std::make_move_iterator(chunks.end()));
+			reindex();
+		}
+		return { a, removed, inserted, tokenDelta };
+	}
+
+	TokenView IncrementalLexer::token(size_t index) const
+	{
+		size_t k = m_tokenCounts.find(index);
+		TokenView token = m_chunks[k].tokens[index - firstToken(k)];
+		token.offset += chunkStart(k);
+		return token;
+	}
+
+	TokenBuffer IncrementalLexer::tokens() const
+	{
+		TokenBuffer tokens;
+		tokens.reserve(tokenCount());
+		size_t start = 0;
+		for (auto& chunk : m_chunks)
+		{
+			for (size_t i = 0; i < chunk.tokens.size(); i++)
+			{
+				TokenView token = chunk.tokens[i];
+				token.offset += start;
+				tokens.push_back(token, chunk.tokens.values[i]);
+			}
+			start += chunk.bytes;
+		}
+		return tokens;
+	}
+
+	std::vector<Diagnostic> IncrementalLexer::diagnostics() const
+	{
+		std::vector<Diagnostic> records;
+		size_t start = 0, line = 1;
+		for (auto& chunk : m_chunks)
+		{
+			for (Diagnostic record : chunk.diagnostics)
+			{
+				record.offset += start;
+				record.line += static_cast<std::uint32_t>(line);
+				records.push_back(record);
+			}
+			start += chunk.bytes;
+			line += chunk.newlines;
+		}
+		return records;
+	}
+
+	void IncrementalLexer::printDiagnostics(std::ostream& out) const
+	{
+		std::string text;
+		for (auto& record : diagnostics())
+			text += Diagnostics::message(record, m_text.substr(record.offset, record.length));
+		out << text;
+	}
+}
@@ -0,0 +1,95 @@
+#include "IncrementalParser.hpp"
+#include <algorithm>
+
+namespace PL0
+{
+	IncrementalParser::IncrementalParser(const std::string& filename, const std::string& rules)
+		: m_lexer(filename), m_grammar(rules)
+	{
+	}
+
+	const ParseResult& IncrementalParser::parse()
+	{
+		m_checkpoints.assign(m_lexer.chunkCount(), {});
+		m_checkpoints[0] = { m_grammar.m_endMarker, 0 };
+		run(0, m_lexer.chunkCount(), 0, {});
+		return m_result;
+	}
+
+	const ParseResult& IncrementalParser::edit(const TextEdit& edit)
+	{
+		ChunkEdit change = m_lexer.edit(edit);
+		if (m_checkpoints.empty())
+			return parse();
+
+		// Line the checkpoints up with the chunks again; the first replaced chunk keeps its own
+		// if it survived, since the tokens before it did not change.
+		size_t kept = change.inserted > 0 ? 1 : 0;
+		size_t drop = change.removed - kept, add = change.inserted - kept;
+		if (drop != add)
+		{
+			auto at = m_checkpoints.erase(m_checkpoints.begin() + change.first + kept, m_checkpoints.begin() + change.first + kept + drop);
+			m_checkpoints.insert(at, add, {});
+		}
+
+		size_t resume = change.first + kept - 1;
+		size_t reached = m_reached;
+		if (reached >= change.first + change.removed)
+			reached = reached - change.removed + change.inserted;
+		else if (reached >= change.first)
+			reached = resume;
+		m_reached = reached;
+
+		// The previous parse stopped before the edit, on tokens that are still there.
+		if (resume > reached)
+			return m_result;
+
+		ParseResult outcome = m_result;
+		if (!outcome.accepted)
+			outcome.errorToken += change.tokenDelta;
+		run(resume, change.first + change.inserted, reached, std::move(outcome));
+		return m_result;
+	}
+
+	void IncrementalParser::run(size_t chunk, size_t convergeFrom, size_t oldReached, ParseResult outcome)
+	{
+		std::vector<GrammarSymbol> stack = m_checkpoints[chunk];
+		const TokenChunk* current = &m_lexer.chunk(chunk);
+		size_t token = m_lexer.firstToken(chunk), local = 0;
+		while (true)
+		{
+			// Entering a chunk: if the previous parse got here with the same stack, the rest of it holds.
+			while (local == current->tokens.size() && chunk + 1 < m_lexer.chunkCount())
+			{
+				current = &m_lexer.chunk(++chunk);
+				local = 0;
+				if (chunk >= convergeFrom && chunk <= oldReached && m_checkpoints[chunk] == stack)
+				{
+					m_reached = oldReached;
+					m_result = std::move(outcome);
+					return;
+				}
+				m_checkpoints[chunk] = stack;
+			}
+
+			TokenKind kind = local < current->tokens.size() ? current->tokens.kinds[local] : TokenKind::ENDOFFILE;
+			GrammarSymbol top = stack.back();
+			int rule = 0;
+			ParseStep step = m_grammar.step(stack, m_grammar.symbolOf(kind), rule);
+			if (step == ParseStep::MATCH)
+			{
+				local++;
+				token++;
+			}
+			else if (step != ParseStep::EXPAND)
+			{
+				bool accepted = step == ParseStep::ACCEPT;
+				std::string text = kind == TokenKind::ENDOFFILE ? "#"
+					: m_lexer.text(m_lexer.chunkStart(chunk) + current->tokens.offsets[local], current->tokens.lengths[local]);
+				m_reached = chunk;
+				m_result = { accepted, accepted ? 0 : token, m_grammar.describe(step, top, text) };
+				return;
+			}
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#include "Interner.hpp"
+#include <cstring>
+
+namespace PL0
+{
+	Interner::Interner()
+		: m_slots(64, NoSymbol)
+	{
+		intern("");
+	}
+
+	std::uint64_t Interner::hash(std::string_view str)
+	{
+		// FNV-1a
+		std::uint64_t h = 14695981039346656037ull;
+		for (unsigned char c : str)
+			h = (h ^ c) * 1099511628211ull;
+		return h;
+	}
+
+	size_t Interner::probe(std::string_view str, std::uint64_t hash) const
+	{
+		size_t mask = m_slots.size() - 1;
+		size_t slot = hash & mask;
+		while (m_slots[slot] != NoSymbol
+			&& (m_hashes[m_slots[slot]] != hash || m_names[m_slots[slot]] != str))
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	std::optional<SymbolId> Interner::find(std::string_view str) const
+	{
+		SymbolId id = m_slots[probe(str, hash(str))];
+		if (id == NoSymbol)
+			return std::nullopt;
+		return id;
+	}
+
+	SymbolId Interner::intern(std::string_view str)
+	{
+		std::uint64_t h = hash(str);
+		size_t slot = probe(str, h);
+		if (m_slots[slot] != NoSymbol)
+			return m_slots[slot];
+
+		SymbolId id = static_cast<SymbolId>(m_names.size());
+		m_names.push_back(store(str));
+		m_hashes.push_back(h);
+		m_slots[slot] = id;
+
+		// Keep the load factor at or below one half.
+		if (m_names.size() * 2 > m_slots.size())
+			rehash();
+		return id;
+	}
+
+	std::string_view Interner::store(std::string_view str)
+	{
+		if (str.empty())
+			return {};
+
+		// Names are packed into fixed blocks that never move. A long name gets a block of its own,
+		// slotted in before the one being filled.
+		if (str.size() > BlockSize / 4)
+		{
+			auto own = std::make_unique<char[]>(str.size());
+			std::memcpy(own.get(), str.data(), str.size());
+			std::string_view view(own.get(), str.size());
+			m_blocks.insert(m_blocks.empty() ? m_blocks.end() : m_blocks.end() - 1, std::move(own));
+			return view;
+		}
+
+		if (str.size() > BlockSize - m_blockUsed)
+		{
+			m_blocks.push_back(std::make_unique<char[]>(BlockSize));
+			m_blockUsed = 0;
+		}
+
+		char* at = m_blocks.back().get() + m_blockUsed;
+		std::memcpy(at, str.data(), str.size());
+		m_blockUsed += str.size();
+		return { at, str.size() };
+	}
+
+	void Interner::rehash()
+	{
+		m_slots.assign(m_slots.size() * 2, NoSymbol);
+		size_t mask = m_slots.size() - 1;
+		for (SymbolId id = 0; id < m_names.size(); id++)
+		{
+			size_t slot = m_hashes[id] & mask;
+			while (m_slots[slot] != NoSymbol)
+				slot = (slot + 1) & mask;
+			m_slots[slot] = id;
+		}
+	}
+}
@@ -1,8 +1,74 @@
 #include <LL1Parser.hpp>
 #include <algorithm>
+#include <numeric>
+#include <set>
+#include <utility>
 
 namespace PL0
 {
+	namespace
+	{
+		bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+		// Rules that separate their symbols with spaces use names; the compact form never has spaces.
+		bool isNamedForm(const std::vector<std::string>& rules)
+		{
+			return std::any_of(rules.begin(), rules.end(), [](const std::string& rule) {
+				return rule.find_first_of(" \t") != std::string::npos;
+			});
+		}
+
+		std::string_view trim(std::string_view text)
+		{
+			while (!text.empty() && isBlank(text.front()))
+				text.remove_prefix(1);
+			while (!text.empty() && isBlank(text.back()))
+				text.remove_suffix(1);
+			return text;
+		}
+
+		struct SplitRule
+		{
+			std::string_view left;
+			std::vector<std::string_view> right;  // Without epsilon.
+		};
+
+		// Fills `split`, reusing its storage across rules.
+		void splitRule(std::string_view rule, bool named, SplitRule& split)
+		{
+			size_t arrow = rule.find("->");
+			split.right.clear();
+			if (!named)
+			{
+				if (arrow != 1)
+					throw UnMatched(std::string(rule));
+				split.left = rule.substr(0, 1);
+				for (size_t i = 3; i < rule.size(); i++)
+					if (rule[i] != 'e')
+						split.right.push_back(rule.substr(i, 1));
+				return;
+			}
+
+			split.left = arrow == std::string_view::npos ? std::string_view() : trim(rule.substr(0, arrow));
+			if (split.left.empty() || std::any_of(split.left.begin(), split.left.end(), isBlank))
+				throw UnMatched(std::string(rule));
+			std::string_view right = rule.substr(arrow + 2);
+			for (size_t begin = 0; begin < right.size(); )
+			{
+				if (isBlank(right[begin]))
+				{
+					begin++;
+					continue;
+				}
+				size_t end = begin;
+				while (end < right.size() && !isBlank(right[end]))
+					end++;
+				split.right.push_back(right.substr(begin, end - begin));
+				begin = end;
+			}
+		}
+	}
+
 	Grammar::Grammar(const std::string& rules)
 	{
 		std::ifstream file(rules);
@@ -10,197 +76,436 @@ namespace PL0
 			throw OpenFileFailed(rules);
 		std::stringstream ss;
 		ss << file.rdbuf();
-		std::string line;
-		while (std::getline(ss, line))
-			m_Rules.push_back(line);
-		for (auto &rule : m_Rules)
+		std::string text = std::move(ss).str();
+		for (size_t begin = 0, end; begin < text.size(); begin = end + 1)
 		{
-			char left = rule[0];
-			if (!contain(m_Vn, left))
-				m_Vn.push_back(left);
-		}
-		for (auto &rule : m_Rules)
+			end = std::min(text.find('\n', begin), text.size());
+			m_Rules.emplace_back(text, begin, end - begin);
+		}
+		m_named = isNamedForm(m_Rules);
+
+		// Small grammars build faster than a cache file can be opened.
+		bool cached = m_Rules.size() >= CacheMinRules;
+		if (cached && loadCache(rules + CacheSuffix, text))
+			return;
+		build();
+		if (cached)
+			saveCache(rules + CacheSuffix, text);
+	}
+
+	Grammar::Grammar(std::vector<std::string> rules) : m_Rules(std::move(rules)), m_named(isNamedForm(m_Rules))
+	{
+		build();
+	}
+
+	void Grammar::build()
+	{
+		SplitRule split;
+		if (!m_named)
 		{
-			std::string right = rule.substr(3);
-			for (int i=0;i<right.size();i++)
-				if (!(right[i] >= 'A' && right[i] <= 'Z'))
-					if (!contain(m_Vt, right[i]))
-						m_Vt.push_back(right[i]);
+			// The compact form keeps 'e' in Vt and leaves uppercase letters out of it.
+			std::array<bool, 256> seen{};
+			for (auto &rule : m_Rules)
+			{
+				splitRule(rule, m_named, split);
+				if (!seen[static_cast<unsigned char>(rule[0])])
+					m_Vn.emplace_back(1, rule[0]);
+				seen[static_cast<unsigned char>(rule[0])] = true;
+			}
+			seen.fill(false);
+			for (auto &rule : m_Rules)
+				for (unsigned char c : std::string_view(rule).substr(3))
+					if (!(c >= 'A' && c <= 'Z') && !seen[c])
+					{
+						m_Vt.emplace_back(1, static_cast<char>(c));
+						seen[c] = true;
+					}
 		}
-		
-		for (auto& vn : m_Vn) {
-			m_First[vn] = std::set<char>();
-			m_Follow[vn] = std::set<char>();
+		else
+		{
+			std::set<std::string, std::less<>> seen;
+			for (auto &rule : m_Rules)
+			{
+				splitRule(rule, m_named, split);
+				if (seen.emplace(split.left).second)
+					m_Vn.emplace_back(split.left);
+			}
+			for (auto &rule : m_Rules)
+			{
+				splitRule(rule, m_named, split);
+				for (std::string_view name : split.right)
+					if (seen.emplace(name).second)
+						m_Vt.emplace_back(name);
+			}
 		}
-		
+
+		encodeSymbols();
+		calNullable();
 		calFirstSet();
 		calFollowSet();
+		calPredictTable();
+	}
 
-		std::vector<char> terminals = m_Vt;
-		terminals.push_back('#');
-		auto it = std::find(terminals.begin(), terminals.end(), 'e');
-		if (it != terminals.end()) {
-			terminals.erase(it);
+	namespace
+	{
+		// `feeds[x]` lists the sets that must contain `sets[x]`; grow them until nothing changes.
+		void propagate(std::vector<SymbolSet>& sets, const std::vector<std::vector<GrammarSymbol>>& feeds)
+		{
+			std::vector<GrammarSymbol> work;
+			std::vector<bool> queued(sets.size(), true);
+			for (size_t x = sets.size(); x-- > 0; )
+				work.push_back(static_cast<GrammarSymbol>(x));
+			while (!work.empty())
+			{
+				GrammarSymbol x = work.back();
+				work.pop_back();
+				queued[x] = false;
+				for (GrammarSymbol y : feeds[x])
+				{
+					if (!sets[y].merge(sets[x]))
+						continue;
+					if (!queued[y])
+					{
+						queued[y] = true;
+						work.push_back(y);
+					}
+				}
+			}
 		}
+	}
 
-		for (auto k1 : m_Vn) {
-			for (auto k2 : terminals) {
-				m_PredictTable[{k1, k2}] = " ";
-				m_RuleRowTable[{k1, k2}] = 0;
+	void Grammar::calNullable()
+	{
+		// A rule made only of nonterminals waits on each of them; when the last one turns out to be
+		// nullable, so is its left side.
+		std::vector<std::vector<std::uint32_t>> uses(m_Vn.size());
+		std::vector<std::uint32_t> pending(m_Rules.size(), 0);
+		std::vector<GrammarSymbol> work;
+		m_nullable = SymbolSet(m_symbols.size());
+		for (size_t i = 0; i < m_Rules.size(); i++)
+		{
+			auto right = pushSymbols(static_cast<int>(i));
+			if (!std::all_of(right.begin(), right.end(), [this](GrammarSymbol s) { return isNonterminal(s); }))
+				continue;
+			pending[i] = static_cast<std::uint32_t>(right.size());
+			for (GrammarSymbol s : right)
+				uses[s].push_back(static_cast<std::uint32_t>(i));
+			if (right.empty() && !m_nullable[m_ruleLeft[i]])
+			{
+				m_nullable.set(m_ruleLeft[i]);
+				work.push_back(m_ruleLeft[i]);
 			}
 		}
-		calPredictTable();
+		while (!work.empty())
+		{
+			GrammarSymbol x = work.back();
+			work.pop_back();
+			for (std::uint32_t rule : uses[x])
+				if (--pending[rule] == 0 && !m_nullable[m_ruleLeft[rule]])
+				{
+					m_nullable.set(m_ruleLeft[rule]);
+					work.push_back(m_ruleLeft[rule]);
+				}
+		}
 	}
 
 	void Grammar::calFirstSet()
 	{
-		bool changed = true;
-		while (changed) {
-			changed = false;
-			for (int i=0;i<m_Rules.size();i++)
+		// FIRST(Y) flows into FIRST(A) for every Y in a rule A->...Y... whose prefix before Y is nullable.
+		m_First.assign(m_Vn.size(), SymbolSet(m_symbols.size()));
+		std::vector<std::vector<GrammarSymbol>> feeds(m_Vn.size());
+		for (size_t i = 0; i < m_Rules.size(); i++)
+		{
+			GrammarSymbol left = m_ruleLeft[i];
+			auto right = pushSymbols(static_cast<int>(i));
+			for (auto it = right.rbegin(); it != right.rend(); ++it)
 			{
-				std::string rule = m_Rules[i];
-				char left = rule[0];
-				std::string right = rule.substr(3);
-				if (islower(right[0])) // ident or number or epsilon
+				if (!isNonterminal(*it))
 				{
-					if(m_First[left].insert(right[0]).second)
-						changed = true;
-				}
-				else {
-					// nonterminal signal
-					for (int j=0;j<right.size();j++)
-					{
-						if (isupper(right[j])) // if signal is non terminal
-						{
-							size_t sizeBefore = m_First[left].size();
-							std::set<char> temp = m_First[right[j]];
-							m_First[left].insert(temp.begin(), temp.end());
-							size_t sizeAfter = m_First[left].size();
-							if (sizeBefore != sizeAfter)
-								changed = true;
-							if (temp.find('e') == temp.end()) // if e is not in the set
-								break;
-						}
-						else // + - * / ( )
-						{
-							if (m_First[left].insert(right[j]).second)
-								changed = true;
-							break;
-						}
-					}
+					if (*it != NoSymbol)
+						m_First[left].set(*it);
+					break;
 				}
+				feeds[*it].push_back(left);
+				if (!m_nullable[*it])
+					break;
 			}
 		}
+		propagate(m_First, feeds);
 	}
 
 	void Grammar::calFollowSet()
 	{
-		m_Follow[m_Vn[0]].insert('#');  // Assume '#' is end-of-input marker for the start symbol
-
-		bool changed = true;
-		while (changed)
+		// Walk each right side backwards, carrying the FIRST of what follows. FOLLOW(A) flows into
+		// FOLLOW(B) when B ends the rule or only nullable symbols come after it.
+		m_Follow.assign(m_Vn.size(), SymbolSet(m_symbols.size()));
+		m_Follow[0].set(m_endMarker);  // Assume '#' is end-of-input marker for the start symbol
+		std::vector<std::vector<GrammarSymbol>> feeds(m_Vn.size());
+		SymbolSet trailer(m_symbols.size());
+		for (size_t i = 0; i < m_Rules.size(); i++)
 		{
-			changed = false;
-			for (int i = 0; i < m_Rules.size(); i++)
+			GrammarSymbol left = m_ruleLeft[i];
+			trailer.reset();
+			bool reachesEnd = true;
+			for (GrammarSymbol s : pushSymbols(static_cast<int>(i)))
 			{
-				std::string rule = m_Rules[i];
-				char left = rule[0];
-				std::string right = rule.substr(3);
-				for (int j = 0; j < right.size(); j++)
+				if (!isNonterminal(s))
 				{
-					if (contain(m_Vn, right[j])) // Check if right[j] is a nonterminal
-					{
-						char B = right[j];
-						size_t next = static_cast<size_t>(j + 1);
-						bool epsilon = true;
-
-						while (next < right.size() && epsilon)
-						{
-							epsilon = false;
-							if (contain(m_Vn, right[next]))
-							{
-								for (char symbol : m_First[right[next]])
-								{
-									if (symbol != 'e') {//epsilon
-										bool inserted = m_Follow[B].insert(symbol).second;
-										changed = changed || inserted;
-									}
-									else
-										epsilon = true;
-								}
-
-							}
-							else if (contain(m_Vt, right[next])) {
-								bool inserted = m_Follow[B].insert(right[next]).second;
-								changed = changed || inserted;
-								break;  
-							}
-
-							++next;
-						}
-
-						// If  derives  or no symbols after B, add FOLLOW(A) to FOLLOW(B)
-						if (next >= right.size() || epsilon)
-						{
-							for (char symbol : m_Follow[left])
-							{
-								bool inserted = m_Follow[B].insert(symbol).second;
-								changed = changed || inserted;
-							}
-						}
-					}
+					trailer.reset();
+					if (s != NoSymbol)
+						trailer.set(s);
+					reachesEnd = false;
+					continue;
+				}
+				m_Follow[s] |= trailer;
+				if (reachesEnd)
+					feeds[left].push_back(s);
+				if (m_nullable[s])
+					trailer |= m_First[s];
+				else
+				{
+					trailer = m_First[s];
+					reachesEnd = false;
 				}
 			}
 		}
+		propagate(m_Follow, feeds);
+	}
+
+	void Grammar::encodeSymbols()
+	{
+		m_symbols = m_Vn;
+		for (auto& vt : m_Vt)
+			if (vt != "#" && (m_named || vt != "e"))
+				m_symbols.push_back(vt);
+		m_symbols.push_back("#");
+		if (m_symbols.size() >= NoSymbol)
+			throw InputTooLarge("grammar symbols");
+		if (m_Rules.size() > size_t(INT16_MAX))
+			throw InputTooLarge("grammar rules");
+		indexSymbols();
+
+		m_ruleLeft.clear();
+		m_rhs.clear();
+		m_rhsStart.assign(1, 0);
+		SplitRule split;
+		for (auto& rule : m_Rules)
+		{
+			splitRule(rule, m_named, split);
+			m_ruleLeft.push_back(symbolOf(split.left));
+			for (size_t i = split.right.size(); i-- > 0; )
+				m_rhs.push_back(symbolOf(split.right[i]));
+			m_rhsStart.push_back(static_cast<std::uint32_t>(m_rhs.size()));
+		}
+	}
+
+	void Grammar::indexSymbols()
+	{
+		m_symbolNames.clear();
+		m_symbolId.fill(NoSymbol);
+		for (size_t id = 0; id < m_symbols.size(); id++)
+		{
+			m_symbolNames.emplace(m_symbols[id], static_cast<GrammarSymbol>(id));
+			if (m_symbols[id].size() == 1)
+				m_symbolId[static_cast<unsigned char>(m_symbols[id][0])] = static_cast<GrammarSymbol>(id);
+		}
+		m_endMarker = symbolOf('#');
+
+		// Compact grammars spell a token by its character, named ones by its kind's name.
+		for (size_t kind = 0; kind < m_kindSymbol.size(); kind++)
+		{
+			GrammarSymbol symbol = m_named ? symbolOf(tokenKindName(static_cast<TokenKind>(kind))) : symbolOf(terminalOf(static_cast<TokenKind>(kind)));
+			m_kindSymbol[kind] = symbol != NoSymbol && !isNonterminal(symbol) ? symbol : NoSymbol;
+		}
+		m_kindSymbol[static_cast<size_t>(TokenKind::ENDOFFILE)] = m_endMarker;
+	}
+
+	GrammarSymbol Grammar::symbolOf(std::string_view name) const
+	{
+		if (name.size() == 1)
+			return symbolOf(name[0]);
+		auto found = m_symbolNames.find(name);
+		return found == m_symbolNames.end() ? NoSymbol : found->second;
+	}
+
+	std::string_view Grammar::rightSide(int rule) const
+	{
+		std::string_view text = m_Rules[rule];
+		if (!m_named)
+			return text.substr(3);
+		return trim(text.substr(text.find("->") + 2));
+	}
+
+	int Grammar::ruleOf(std::string_view rule) const
+	{
+		// Compared symbol by symbol, so a named rule may be spaced differently from the rules file.
+		SplitRule split;
+		splitRule(rule, m_named, split);
+		GrammarSymbol left = symbolOf(split.left);
+		for (size_t index = 0; index < m_Rules.size(); index++)
+		{
+			std::span<const GrammarSymbol> pushed = pushSymbols(static_cast<int>(index));
+			if (m_ruleLeft[index] != left || pushed.size() != split.right.size())
+				continue;
+			size_t i = 0;
+			while (i < pushed.size() && pushed[pushed.size() - 1 - i] == symbolOf(split.right[i]))
+				i++;
+			if (i == pushed.size())
+				return static_cast<int>(index);
+		}
+		return NoProduction;
+	}
+
+	size_t Grammar::symbolCount(std::string_view rule) const
+	{
+		SplitRule split;
+		splitRule(rule, m_named, split);
+		return split.right.size();
+	}
+
+	std::string Grammar::describe(ParseStep step, GrammarSymbol top, std::string_view lookahead) const
+	{
+		switch (step)
+		{
+		case ParseStep::ACCEPT:
+			return "Parse successfully!";
+		case ParseStep::EXTRA_INPUT:
+			return "Parse failed,extra symbols appeared.";
+		case ParseStep::NO_PRODUCTION:
+			// Compact grammars have one-character symbols, so they name the lookahead's first character.
+			return std::format("Error: No production found for {} and {}", spelling(top), m_named ? lookahead : lookahead.substr(0, 1));
+		case ParseStep::NOT_FOUND:
+			return std::format("Signal {} not found in expression", spelling(top));
+		default:
+			return "";
+		}
 	}
 
 	void Grammar::calPredictTable()
 	{
-		for(int i = 0; i < m_Rules.size(); i++)
+		// Rule i goes under FIRST of its right side, plus FOLLOW of its left side if that is nullable.
+		// A cell two rules claim means the grammar is not LL(1), which is rejected as StaticParser does.
+		struct Cell
 		{
-			std::string rule = m_Rules[i];
-			char left = rule[0];
-			std::string right = rule.substr(3);
-			if (contain(m_Vn, right[0])) // If the first symbol on the right-hand side is a nonterminal
+			GrammarSymbol symbol;
+			std::int16_t rule;
+		};
+
+		// Visit the rules grouped by left side, keeping their order, to collect each row sorted by symbol.
+		std::vector<std::uint32_t> groupStart(m_Vn.size() + 1, 0), grouped(m_Rules.size());
+		for (GrammarSymbol left : m_ruleLeft)
+			groupStart[left + 1]++;
+		std::partial_sum(groupStart.begin(), groupStart.end(), groupStart.begin());
+		std::vector<std::uint32_t> fill(groupStart.begin(), groupStart.end() - 1);
+		for (size_t i = 0; i < m_Rules.size(); i++)
+			grouped[fill[m_ruleLeft[i]]++] = static_cast<std::uint32_t>(i);
+
+		std::vector<Cell> cells;
+		std::vector<std::uint32_t> rowStart(m_Vn.size() + 1, 0);
+		std::vector<std::int16_t> ruleAt(m_symbols.size(), NoProduction);
+		SymbolSet predicted(m_symbols.size()), row(m_symbols.size());
+		for (size_t nonTerminal = 0; nonTerminal < m_Vn.size(); nonTerminal++)
+		{
+			row.reset();
+			for (size_t g = groupStart[nonTerminal]; g < groupStart[nonTerminal + 1]; g++)
 			{
-				for (char a : m_First.at(right[0])) // For each terminal in FIRST(right[0])
+				std::uint32_t i = grouped[g];
+				auto right = pushSymbols(static_cast<int>(i));
+				predicted.reset();
+				bool nullable = true;
+				for (auto it = right.rbegin(); it != right.rend() && nullable; ++it)
 				{
-					if (a != 'e')
+					if (!isNonterminal(*it))
 					{
-						m_PredictTable[{left, a}] = right;
-						m_RuleRowTable[{left, a}] = i + 1;
+						if (*it != NoSymbol)
+							predicted.set(*it);
+						nullable = false;
 					}
-				}
-
-				if (m_First.at(right[0]).find('e') != m_First.at(right[0]).end()) // If FIRST(right[0]) contains epsilon
-				{
-					for (char b : m_Follow.at(left))
+					else
 					{
-						m_PredictTable[{left, b}] = right;
-						m_RuleRowTable[{left, b}] = i + 1;
+						predicted |= m_First[*it];
+						nullable = m_nullable[*it];
 					}
 				}
+				if (nullable)
+					predicted |= m_Follow[nonTerminal];
+
+				predicted.forEach([&](size_t terminal) {
+					if (row[terminal])
+						throw PredictConflict(m_Rules[ruleAt[terminal]], m_Rules[i], spelling(static_cast<GrammarSymbol>(terminal)));
+					ruleAt[terminal] = static_cast<std::int16_t>(i);
+				});
+				row |= predicted;
 			}
-			else // If the first symbol on the right-hand side is a terminal
+			row.forEach([&](size_t terminal) { cells.push_back({ static_cast<GrammarSymbol>(terminal), ruleAt[terminal] }); });
+			rowStart[nonTerminal + 1] = static_cast<std::uint32_t>(cells.size());
+		}
+
+		// Place the fullest rows first, each at the lowest offset where all its cells find free slots.
+		// Rows and used slots are bitmasks, so an offset is tried a word at a time, and only offsets
+		// putting the row's first cell on a free slot are tried at all.
+		auto rowSize = [&](size_t nonTerminal) { return rowStart[nonTerminal + 1] - rowStart[nonTerminal]; };
+		std::vector<size_t> order(m_Vn.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return rowSize(a) > rowSize(b); });
+		m_base.assign(m_Vn.size(), 0);
+		m_entries.clear();
+		m_entries.reserve(cells.size() + m_symbols.size());
+		std::vector<std::uint64_t> used;
+		auto window = [&](size_t slot) {
+			size_t word = slot / 64, shift = slot % 64;
+			std::uint64_t bits = word < used.size() ? used[word] >> shift : 0;
+			if (shift != 0 && word + 1 < used.size())
+				bits |= used[word + 1] << (64 - shift);
+			return bits;
+		};
+		auto nextFree = [&](size_t slot) {
+			for (size_t word = slot / 64; word < used.size(); word++)
 			{
-				if (right[0] != 'e')
-				{
-					// Add the production rule to the predictive parsing table
-					m_PredictTable[{left, right[0]}] = right;
-                    m_RuleRowTable[{left, right[0]}] = i + 1;
-				}
-				else {
-					// If the right-hand side is epsilon, consider follow set of the left-hand symbol
-					for (char b : m_Follow.at(left))
-					{
-						// Add the production rule to the predictive parsing table
-						m_PredictTable[{left, b}] = right;
-                        m_RuleRowTable[{left, b}] = i + 1;
-					}
-				}
+				std::uint64_t free = ~used[word] & (word == slot / 64 ? ~std::uint64_t(0) << (slot % 64) : ~std::uint64_t(0));
+				if (free != 0)
+					return word * 64 + std::countr_zero(free);
+			}
+			return std::max(slot, used.size() * 64);
+		};
+
+		std::vector<std::uint64_t> mask;
+		for (size_t nonTerminal : order)
+		{
+			if (rowSize(nonTerminal) == 0)
+				continue;
+			std::span<const Cell> cellsOf(cells.data() + rowStart[nonTerminal], rowSize(nonTerminal));
+			// Bit k of the mask is the cell for symbol front + k.
+			GrammarSymbol front = cellsOf.front().symbol;
+			mask.assign((cellsOf.back().symbol - front) / 64 + 1, 0);
+			for (const Cell& cell : cellsOf)
+				mask[(cell.symbol - front) / 64] |= std::uint64_t(1) << ((cell.symbol - front) % 64);
+
+			size_t slot = nextFree(0);
+			while (true)
+			{
+				bool fits = true;
+				for (size_t w = 0; w < mask.size() && fits; w++)
+					fits = (mask[w] & window(slot + w * 64)) == 0;
+				if (fits)
+					break;
+				slot = nextFree(slot + 1);
+			}
+
+			std::int64_t base = std::int64_t(slot) - front;
+			m_base[nonTerminal] = static_cast<std::int32_t>(base);
+			size_t end = slot + (cellsOf.back().symbol - front) + 1;
+			if (end > m_entries.size())
+			{
+				m_entries.resize(end, { NoSymbol, NoProduction });
+				used.resize((end + 63) / 64, 0);
+			}
+			for (const Cell& cell : cellsOf)
+			{
+				size_t at = static_cast<size_t>(base + cell.symbol);
+				m_entries[at] = { static_cast<GrammarSymbol>(nonTerminal), cell.rule };
+				used[at / 64] |= std::uint64_t(1) << (at % 64);
 			}
-			
 		}
 	}
 
@@ -210,361 +515,383 @@ namespace PL0
 		return it != vec.end();
 	}
 
-	void Grammar::printRules() 
+	void Grammar::printRules() const
 	{
 		for (auto &rule : m_Rules)
 			std::cout << rule << std::endl;
-	}	
+	}
 
-	void Grammar::printVn()
+	void Grammar::printVn() const
 	{
 		for (auto &vn : m_Vn)
 			std::cout << vn << " ";
 		std::cout << std::endl;
 	}
 
-	void Grammar::printVt()
+	void Grammar::printVt() const
 	{
 		for (auto &vt : m_Vt)
 			std::cout << vt << " ";
 		std::cout << std::endl;
 	}
 
-	void Grammar::printFirstSet()
-	{			
-		for (const auto& pair : m_First) {
-			char non_terminal = pair.first;
-			const std::set<char>& first_set = pair.second;
-
-			std::cout << "FIRST(" << non_terminal << ") = {";
-
-			for (auto iter = first_set.begin(); iter != first_set.end(); ++iter) {
-				if (iter != first_set.begin()) {
+	void Grammar::printSets(const char* name, const std::vector<SymbolSet>& sets, bool withEpsilon) const
+	{
+		std::vector<std::string> nonTerminals = m_Vn;
+		std::sort(nonTerminals.begin(), nonTerminals.end());
+		for (auto& non_terminal : nonTerminals) {
+			GrammarSymbol id = symbolOf(non_terminal);
+			std::vector<std::string_view> members;
+			for (size_t symbol = m_Vn.size(); symbol < m_symbols.size(); symbol++)
+				if (sets[id][symbol])
+					members.push_back(m_symbols[symbol]);
+			if (withEpsilon && m_nullable[id])
+				members.push_back("e");
+			std::sort(members.begin(), members.end());
+
+			std::cout << name << "(" << non_terminal << ") = {";
+			for (size_t i = 0; i < members.size(); i++) {
+				if (i != 0) {
 					std::cout << ", ";
 				}
-				std::cout << *iter;
+				std::cout << members[i];
 			}
 			std::cout << "}" << std::endl;
 		}
 	}
 
-	void Grammar::printFollowSet()
+	void Grammar::printFirstSet() const
 	{
-		for (const auto& pair : m_Follow) {
-			char non_terminal = pair.first;
-			const std::set<char>& follow_set = pair.second;
-
-			std::cout << "FOLLOW(" << non_terminal << ") = {";
-
-			for (auto iter = follow_set.begin(); iter != follow_set.end(); ++iter) {
-				if (iter != follow_set.begin()) {
-					std::cout << ", ";
-				}
-				std::cout << *iter;
-			}
-			std::cout << "}" << std::endl;
-		}
+		printSets("FIRST", m_First, true);
 	}
 
-	void Grammar::printPredictTable()
+	void Grammar::printFollowSet() const
 	{
-		const int width = 8; 
-		std::cout << std::left; 
+		printSets("FOLLOW", m_Follow, false);
+	}
 
-		std::vector<char> terminals = m_Vt;
-		terminals.push_back('#');
-		auto it = std::find(terminals.begin(), terminals.end(), 'e');
-		if (it != terminals.end()) {
-			terminals.erase(it); 
-		}
+	void Grammar::printPredictTable() const
+	{
+		size_t width = 8;
+		for (auto& symbol : m_symbols)
+			width = std::max(width, symbol.size() + 2);
+		for (size_t rule = 0; rule < m_Rules.size(); rule++)
+			width = std::max(width, rightSide(static_cast<int>(rule)).size() + 2);
+		std::cout << std::left;
 
 		std::cout << std::setw(width) << ' ';
-		for (char terminal : terminals) {
-			std::cout << std::setw(width) << terminal;
-		}
+		for (size_t terminal = m_Vn.size(); terminal < m_symbols.size(); terminal++)
+			std::cout << std::setw(width) << m_symbols[terminal];
 		std::cout << std::endl;
 
-		for (char nonTerminal : m_Vn) {
-			std::cout << std::setw(width) << nonTerminal;
-			for (char terminal : terminals) {
-				auto it = m_PredictTable.find({ nonTerminal, terminal });
-				if (it != m_PredictTable.end()) {
-					std::cout << std::setw(width) << it->second;
-				}
-				else {
-					std::cout << std::setw(width) << ' '; 
-				}
+		for (size_t nonTerminal = 0; nonTerminal < m_Vn.size(); nonTerminal++) {
+			std::cout << std::setw(width) << m_symbols[nonTerminal];
+			for (size_t terminal = m_Vn.size(); terminal < m_symbols.size(); terminal++) {
+				int rule = predict(static_cast<GrammarSymbol>(nonTerminal), static_cast<GrammarSymbol>(terminal));
+				if (rule != NoProduction)
+					std::cout << std::setw(width) << rightSide(rule);
+				else
+					std::cout << std::setw(width) << ' ';
 			}
 			std::cout << std::endl;
 		}
-		
-	}
-
-	LL1Parser::LL1Parser(const std::string& filename, const std::string& rules) : m_grammar(rules)
-	{
-		std::ifstream input(filename);
-		if (!input.is_open())
-			throw OpenFileFailed(filename);
-
-		std::stringstream buffer;
-		buffer << input.rdbuf();
-		m_file = buffer.str();
-		m_currentLine = 1;
-		m_currentChar = getSign(m_currentLine);
-		
-		input.clear();
-		input.seekg(0, std::ios::beg);
-		std::string line;
-		totalLines = 0;  
-		while (std::getline(input, line)) {
-			++totalLines;  
-		}
-		totalLines += 1; //input like (a+15)*b#
+
 	}
 
-	LL1Parser::~LL1Parser() {}
+	LL1Parser::LL1Parser(const std::string& rules) : LL1Parser(std::make_shared<const Grammar>(rules))
+	{
+	}
 
-	std::string LL1Parser::getSign(int line)
+	LL1Parser::LL1Parser(std::shared_ptr<const Grammar> grammar) : m_tables(std::move(grammar)), m_grammar(*m_tables), m_actions(*m_tables)
 	{
-		std::string sign,linestring;
-		linestring = getFileLine(line);
-		int index = 0;
-		while (linestring[index] != ',')
-			index++;
-		sign += linestring[++index];
-		while (linestring[static_cast<size_t>(index + 1)] != ')')
-			sign += linestring[++index];
-		return sign;
 	}
 
-	void LL1Parser::getL_sdtFile(std::string filename)
+	LL1Parser::LL1Parser(Lexer& lexer, const std::string& rules) : LL1Parser(rules)
 	{
-		std::ifstream file(filename);
-		l_sdt << file.rdbuf();
+		attach(lexer);
 	}
 
-	std::string LL1Parser::getCode(int line)
+	LL1Parser::~LL1Parser() {}
+
+	void LL1Parser::attach(Lexer& lexer)
 	{
-		std::string sign, linestring;
-		linestring = getFileLine(line);
-		int index = 0;
-		while (linestring[static_cast<size_t>(index + 1)] != ',')
-			sign += linestring[++index];
-		return sign;
+		m_stream = &lexer;
+		m_source = &lexer;
+		m_tokens = nullptr;
+		m_stack.clear();
+		m_externStack.clear();
+		advance();
 	}
 
-	std::string LL1Parser::getFileLine(int line)
+	void LL1Parser::attach(const Lexer& lexer, const TokenBuffer& tokens)
 	{
-		std::string res;
-		size_t poi = 0;
-		while (line > 1)
-		{
-			if (line > 0)
-				line--;
-			poi = m_file.find('\n', poi) + 1;
-		}
-		for (size_t i=poi;m_file[i]!='\n' and m_file[i]!='\0';i++)
-			res+=m_file[i];
-		return res;
+		m_stream = nullptr;
+		m_source = &lexer;
+		m_tokens = &tokens;
+		m_nextToken = 0;
+		m_stack.clear();
+		m_externStack.clear();
+		advance();
 	}
 
-	Symbol LL1Parser::switchCode(std::string sign) 
+	void LL1Parser::advance()
 	{
-		switch (sign[0]) 
+		if (m_tokens != nullptr)
 		{
-			case 'i': return Symbol{ 'i',0 };
-			case 'n': return Symbol{ 'n',std::stoi(getSign(m_currentLine)) };
-			case 'p': return Symbol{ '+',0 };
-			case 'm': return Symbol{ '-',0 };
-			case 't': return Symbol{ '*',0 };
-			case 's': return Symbol{ '/',0 };
-			case 'l': return Symbol{ '(',0 };
-			case 'r': return Symbol{ ')',0 };
-			default : return Symbol{ '#',0 };
+			if (m_nextToken < m_tokens->size())
+				m_lookahead = (*m_tokens)[m_nextToken++];
+			else
+				m_lookahead = { TokenType::ENDOFFILE, TokenKind::ENDOFFILE, m_source->source().size(), 0 };
 		}
+		else if (m_stream != nullptr)
+			m_lookahead = m_stream->nextTokenView();
 	}
 
-	Element LL1Parser::switchCode(std::string sign,bool a)
+	std::string LL1Parser::lookaheadText() const
 	{
-		switch (sign[0])
-		{
-			case 'n': return Element{ "n", std::stoi(getSign(m_currentLine)) };
-			case 'p': return Element{ "+" };
-			case 'm': return Element{ "-" };
-			case 't': return Element{ "*" };
-			case 's': return Element{ "/" };
-			case 'l': return Element{ "(" };
-			case 'r': return Element{ ")" };
-			default : return Element{ "#" };
-		}
+		// Lowercased like Lexer::value, as the token files of the original parser were.
+		return atEnd() ? std::string("#") : m_source->value(m_lookahead);
 	}
 
-	void LL1Parser::getOriginFile(std::string filename)
+	void LL1Parser::getL_sdtFile(std::string filename)
 	{
-		std::ifstream code(filename);
-		if (!code.is_open())
-			throw OpenFileFailed(filename);
-		std::stringstream buffer;
-		buffer << code.rdbuf();
-		PL0 = buffer.str();
+		m_actions.read(m_grammar, filename);
 	}
 
-	void LL1Parser::printStack()
+	Symbol LL1Parser::currentSymbol() const
 	{
-		std::cout << "Stack: ";
-		for (int i = 0; i < m_stack.size(); i++)
-			std::cout << m_stack[i];
+		char sign = terminalOf(m_lookahead.kind);
+		return Symbol{ sign, sign == 'n' ? m_lookahead.number : 0 };
 	}
 
-	bool LL1Parser::parse()
+	void LL1Parser::printErrorPosition()
 	{
-		m_stack.push_back('#');
-		m_stack.push_back('E'); 
+		if (m_source == nullptr)
+			return;
+		// Show the source line holding the lookahead with a caret under it.
+		std::string_view source = m_source->source();
+		size_t offset = std::min(m_lookahead.offset, source.size());
+		size_t begin = source.rfind('\n', offset == 0 ? 0 : offset - 1);
+		begin = (begin == std::string_view::npos || begin >= offset) ? 0 : begin + 1;
+		size_t end = std::min(source.find('\n', offset), source.size());
+		std::cout << source.substr(begin, end - begin) << std::endl;
+		std::cout << std::string(offset - begin, ' ') << '*' << std::endl;
+	}
 
-		while (m_stack.back() != '#') {
-			printStack();
+	void LL1Parser::traceLatest()
+	{
+		// Without an attached source, tokens render as '#' like the end of input.
+		std::string_view source = m_source == nullptr ? std::string_view() : m_source->source();
+		Tracer::render(std::cout, m_trace.latest(), m_grammar, source);
+	}
 
-			std::cout<< " Current char: " << m_currentChar << std::endl;
-			
-			Symbol c = (m_currentChar == "#") ? Symbol{'#', 0} : switchCode(getCode(m_currentLine));
-			char top = m_stack.back();
-			if (top == c.sign) {
-				m_stack.pop_back();
-				m_currentLine++;
+	void LL1Parser::traceFailure()
+	{
+		if (m_trace.level() == TraceLevel::ERRORS)
+			m_trace.dump(std::cout, m_grammar, m_source == nullptr ? std::string_view() : m_source->source());
+	}
 
-				if (m_currentLine < totalLines)
-					m_currentChar = getSign(m_currentLine);
-				else 
-					m_currentChar = "#";
-			}
-			else if (m_grammar.contain(m_grammar.m_Vn, top)) {
-				
-				std::string production = m_grammar.m_PredictTable[{top, c.sign}];
-				if (production == " ") 
-				{
-					std::cout << "Error: No production found for " << top << " and " << m_currentChar[0] << std::endl;
-					return false;
-				}
+	void LL1Parser::printStack()
+	{
+		std::cout << "Stack: ";
+		for (GrammarSymbol symbol : m_stack)
+			std::cout << m_grammar.spelling(symbol) << (m_grammar.named() ? " " : "");
+	}
 
-				m_stack.pop_back();
+	bool LL1Parser::parse(Lexer& lexer)
+	{
+		attach(lexer);
+		return parse();
+	}
 
-				for (size_t i = production.size(); i-- > 0; ) {
-					if (production[i] != 'e') {
-						m_stack.push_back(production[i]);
-					}
-				}
+	bool LL1Parser::parse(const Lexer& lexer, const TokenBuffer& tokens)
+	{
+		attach(lexer, tokens);
+		return parse();
+	}
 
+	bool LL1Parser::parse()
+	{
+		m_stack.assign({ m_grammar.m_endMarker, 0 });
+		m_trace.clear();
+
+		while (true) {
+			GrammarSymbol top = m_stack.back();
+			if (top != m_grammar.m_endMarker && m_trace.enabled(TraceLevel::STACKS)) {
+				printStack();
+				std::cout << " Current char: " << lookaheadText() << std::endl;
 			}
-			else {
-				std::cout << "Signal " << top <<" not found in expression " << std::endl;
+
+			size_t depth = m_stack.size();
+			int rule = 0;
+			switch (m_grammar.step(m_stack, m_grammar.symbolOf(m_lookahead.kind), rule)) {
+			case ParseStep::MATCH:
+				trace(TraceEvent::MATCH, top, 0, depth);
+				advance();
+				break;
+			case ParseStep::EXPAND:
+				trace(TraceEvent::EXPAND, top, rule, depth);
+				break;
+			case ParseStep::ACCEPT:
+				std::cout << "Parse successfully!" << std::endl;
+				return true;
+			case ParseStep::EXTRA_INPUT:
+				std::cout << "Parsing failed!" << std::endl;
+				printErrorPosition();
+				traceFailure();
+				return false;
+			case ParseStep::NO_PRODUCTION:
+				trace(TraceEvent::FAIL, top, 0, depth);
+				std::cout << m_grammar.describe(ParseStep::NO_PRODUCTION, top, lookaheadText()) << std::endl;
+				// A byte the lexer could not make a token of also shows where it is, as it always has.
+				if (m_lookahead.kind == TokenKind::NONE)
+				{
+					std::cout << "Parsing failed!" << std::endl;
+					printErrorPosition();
+				}
+				traceFailure();
+				return false;
+			case ParseStep::NOT_FOUND:
+				trace(TraceEvent::FAIL, top, 0, depth);
+				std::cout << "Signal " << m_grammar.spelling(top) <<" not found in expression " << std::endl;
+				traceFailure();
 				return false;
 			}
 		}
-
-		if (m_stack.back() == '#' && m_currentChar == "#") {
-			std::cout << "Parse successfully!" << std::endl;
-			return true;
-		}
-		else {
-			std::cout << "Parsing failed!" << std::endl;
-			std::cout << PL0 << std::endl;
-			for (size_t i = 0; i < m_currentLine; ++i) 
-				std::cout << ' ';
-			std::cout << '*' << std::endl;
-			return false;
-		}
-
-		return m_currentLine==totalLines;
 	}
 
 	void LL1Parser::printExternStack() 
 	{
 		std::cout << "Extern Stack: "<<std::endl;
 		for (size_t i = m_externStack.size()-1; i-- > 0;)
-			std::cout << m_externStack[i].type << std::endl;
+		{
+			const SemanticEntry& entry = m_externStack[i];
+			if (entry.kind == SemanticKind::ACTION)
+				std::cout << "action" << entry.id << std::endl;
+			else
+				std::cout << m_grammar.spelling(entry.id) << (entry.kind == SemanticKind::SYNTHESIZED ? "syn" : "") << std::endl;
+		}
+	}
+
+	void LL1Parser::semanticParse(Lexer& lexer)
+	{
+		attach(lexer);
+		semanticParse();
 	}
 
-	// function : S->/F{12}S{13} ĲΪ S /FS S {13} 13
-	int LL1Parser::getActionNumber(char left, std::string right, char sign)
+	void LL1Parser::semanticParse(const Lexer& lexer, const TokenBuffer& tokens)
 	{
-		l_sdt.clear(); 
-		l_sdt.seekg(0, std::ios::beg); 
-		
-		int result = 0;
-		std::string line;
-		while (std::getline(l_sdt, line))
+		attach(lexer, tokens);
+		semanticParse();
+	}
+
+	void LL1Parser::semanticParse()
+	{
+		std::int64_t value = 0;
+		if (translate(value))
 		{
-			std::string lineRight = line.substr(3);
-			if (line[0] == left && line[3] == right[0])
-			{
-				for (int i = 0; i < lineRight.size(); i++)
-				{
-					if (lineRight[i] == sign)
-					{
-						int index = i+2;
-						std::string r;
-						while (lineRight[index] != '}') {
-							r += (1, lineRight[index]);
-							index += 1;
-						}
-							
-						result = std::stoi(r);
-						break;
-					}
-				}
-				break;
-			}
+			std::cout << "Parse successfully" << std::endl;
+			std::cout << value << std::endl;
 		}
-		return result;
 	}
 
-	void LL1Parser::semanticParse()
+	AstIndex LL1Parser::buildAst(Ast& ast)
+	{
+		// Run the same scheme with node-building actions in place of the registry's own. They point
+		// into `ast`, so the registry is put back however translate leaves, exceptions included.
+		struct Restore
+		{
+			ActionRegistry& registry;
+			ActionRegistry saved;
+			~Restore() { registry = std::move(saved); }
+		} restore{ m_registry, std::exchange(m_registry, ast.actions(m_registry)) };
+
+		std::int64_t root = Ast::NoNode;
+		return translate(root) ? static_cast<AstIndex>(root) : Ast::NoNode;
+	}
+
+	AstIndex LL1Parser::buildAst(Lexer& lexer, Ast& ast)
 	{
-		m_externStack.push_back({ "#" , 0 });
-		m_externStack.push_back({ "Esyn", 0 });
-		m_externStack.push_back({ "E", 0 });
+		attach(lexer);
+		return buildAst(ast);
+	}
+
+	AstIndex LL1Parser::buildAst(const Lexer& lexer, const TokenBuffer& tokens, Ast& ast)
+	{
+		attach(lexer, tokens);
+		return buildAst(ast);
+	}
 
-		while (m_externStack.back().type != "#")
+	bool LL1Parser::translate(std::int64_t& result)
+	{
+		bool accepted = false;
+		m_externStack.assign({
+			{ SemanticKind::TERMINAL, false, m_grammar.m_endMarker },
+			{ SemanticKind::SYNTHESIZED, false, 0 },
+			{ SemanticKind::NONTERMINAL, false, 0 } });
+		m_operand.reset();
+		m_trace.clear();
+
+		while (!m_externStack.back().is(SemanticKind::TERMINAL, m_grammar.m_endMarker))
 		{
-			printExternStack();
-			std::cout << "Current char: " << m_currentChar << std::endl; // ָ
+			if (m_trace.enabled(TraceLevel::STACKS))
+			{
+				printExternStack();
+				std::cout << "Current char: " << lookaheadText() << std::endl; // ָ
+			}
 
-			Element c = (m_currentChar == "#") ? Element{ "#",0 } : 
-				switchCode(getCode(m_currentLine),true); //ǰԪ
+			Symbol c = currentSymbol(); //ǰԪ
+			GrammarSymbol lookahead = m_grammar.symbolOf(m_lookahead.kind);
 
-			Element top = m_externStack.back();
-			if (top.type == c.type)   // ջԪغ͵ǰַƥ  + - * / n
+			SemanticEntry top = m_externStack.back();
+			if (top.is(SemanticKind::TERMINAL, lookahead))   // ջԪغ͵ǰַƥ  + - * / n
 			{
-				m_currentLine++;
-				if (m_currentLine < totalLines)
-					m_currentChar = getSign(m_currentLine);
-				else
-					m_currentChar = "#";
+				trace(TraceEvent::MATCH, top.id, 0, m_externStack.size());
+				advance();
 
-				if (top.type == "n")
+				if (c.sign == 'n')
 				{
 					m_externStack[m_externStack.size() - 2].hasValue = true;
-					m_externStack[m_externStack.size() - 2].value = top.value;
+					m_externStack[m_externStack.size() - 2].value = m_registry.number(c.value);
 				}
 				m_externStack.pop_back();
 			}
-            else if (m_externStack.back().type.size() >= 5)  //ҲactionN
+            else if (top.kind == SemanticKind::ACTION)  //ҲactionN
             {
-                int aindex = std::stoi(m_externStack.back().type.substr(6));
-                actionFunction(aindex);  // to be completed
+                trace(TraceEvent::ACTION, Grammar::NoSymbol, top.id, m_externStack.size());
+				std::string failure;
+				try
+				{
+					actionFunction(top.id);
+				}
+				catch (const ActionFailed& error)
+				{
+					failure = error.what();
+				}
+				catch (const InvalidNode& error)
+				{
+					failure = error.what();
+				}
+				if (!failure.empty())
+				{
+					std::cout << "Error: " << failure << std::endl;
+					printErrorPosition();
+					traceFailure();
+					return false;
+				}
                 m_externStack.pop_back();
             }
-            else if (m_externStack.back().type.size() == 4) // ۺ
+            else if (top.kind == SemanticKind::SYNTHESIZED) // ۺ
             {
-				int value = m_externStack.back().value;
+				std::int64_t value = top.value;
+				trace(TraceEvent::SYNTHESIZE, top.id, 0, m_externStack.size());
 	
-                if (m_externStack.back().hasValue)
+                if (top.hasValue)
                 {
-					size_t s = m_externStack.size();
-                    if (m_externStack[m_externStack.size() - 2].type.size() >= 6 
-						&& ( m_externStack[s - 2].type.substr(6) == "3" || m_externStack[s - 2].type.substr(6) == "5" || m_externStack[s - 2].type.substr(6) == "10" || m_externStack[s - 2].type.substr(6) == "12" ))  
+					const SemanticEntry& next = m_externStack[m_externStack.size() - 2];
+                    if (next.kind == SemanticKind::ACTION && m_registry.binary(next.id))
                     {
-							m_valueCache = value;
+							m_operand = value;
                     }
                     else 
                     {
@@ -575,13 +902,21 @@ namespace PL0
 				
                 m_externStack.pop_back();
 
-				if (m_externStack.back().type == "#" && m_currentChar == "#")
+				if (m_externStack.back().is(SemanticKind::TERMINAL, m_grammar.m_endMarker) && atEnd())
 				{
-					std::cout << "Parse successfully" << std::endl;
-					std::cout << value << std::endl;
+					// A scheme that left the start symbol without a value has no result to give.
+					if (!top.hasValue)
+					{
+						std::cout << "Error: No value synthesized for " << m_grammar.spelling(top.id) << std::endl;
+						printErrorPosition();
+						traceFailure();
+						return false;
+					}
+					accepted = true;
+					result = value;
 				}
             }
-			else if (top.type.size()==1 && m_grammar.contain(m_grammar.m_Vn, top.type[0]))
+			else if (top.kind == SemanticKind::NONTERMINAL)
 			{
 				// example : ջַΪսE 
 				// E->T{a1}G{a2}   T Tsyn {a1} G Gsyn {a2}ջ
@@ -589,192 +924,90 @@ namespace PL0
 				size_t oldTopIndex =  m_externStack.size() - 1 ;
 				// If top has value:
 				//		top.value => newTop.value
-				bool topHasValue = m_externStack.back().hasValue;
-				int topValue = m_externStack.back().value;
-
 				m_externStack.pop_back();
 
-				std::string production = m_grammar.m_PredictTable[{top.type[0], c.type[0]}];
-				int rowIndex = m_grammar.m_RuleRowTable[{top.type[0], c.type[0]}];
-
-				if (production == " ")
+				int rule = m_grammar.predict(top.id, lookahead);
+				if (rule == Grammar::NoProduction)
 				{
-					std::cout << "Error: No production found for " << top.type[0] << " and " << c.type[0] << std::endl;
-					return;
+					trace(TraceEvent::FAIL, top.id, 0, oldTopIndex + 1);
+					std::cout << m_grammar.describe(ParseStep::NO_PRODUCTION, top.id, lookaheadText()) << std::endl;
+					printErrorPosition();
+					traceFailure();
+					return false;
 				}
-					
-				for (size_t i = production.size(); i-- > 0; ) {
-					if (production[i] != 'e') {
-						if (isupper(production[i])) {
-							std::string Nonterminal( 1,production[i] );
-							Element NonterminalElement{ Nonterminal };
-							Element NonterminalSynElement{ Nonterminal + "syn", 0 };
-							int actionindex = getActionNumber(top.type[0], production, production[i]);
-							Element actionElement{ "action" + std::to_string(actionindex), 0 };
-
-							m_externStack.push_back(actionElement);							
-							m_externStack.push_back(NonterminalSynElement);
-							m_externStack.push_back(NonterminalElement);
-						}
-						else // production[i]Ϊ + - * / n ( )
-						{
-							if (production[i] == ')')
-							{
-								int actionindex = getActionNumber(top.type[0], production, production[i]);
-								Element actionElement{ "action" + std::to_string(actionindex), 0 };
-								m_externStack.push_back(actionElement);
-							}
-							
-							Element element{ std::string(1,production[i]) };  //  n ѹջ
-							if (production[i] == 'n')
-							{
-								element.value = c.value;
-							}
-							m_externStack.push_back(element);
-							
-							
-						}
+				trace(TraceEvent::EXPAND, top.id, rule, oldTopIndex + 1);
+
+				// Push the right side in reverse, each symbol under the action that follows it.
+				std::span<const GrammarSymbol> symbols = m_grammar.pushSymbols(rule);
+				size_t firstBinary = std::string_view::npos;
+				if (symbols.empty() && m_actions.after(rule, 0) != ActionTable::None)
+					m_externStack.push_back({ SemanticKind::ACTION, false, m_actions.after(rule, 0) });
+				for (size_t j = 0; j < symbols.size(); j++)
+				{
+					GrammarSymbol symbol = symbols[j];
+					std::uint16_t action = m_actions.after(rule, symbols.size() - 1 - j);
+					if (action != ActionTable::None)
+					{
+						m_externStack.push_back({ SemanticKind::ACTION, false, action });
+						if (m_registry.binary(action))
+							firstBinary = m_externStack.size() - 1;
 					}
-					else
+					if (m_grammar.isNonterminal(symbol))
 					{
-                        int actionindex = getActionNumber(top.type[0], production, production[i]);
-                        Element actionElement{ "action" + std::to_string(actionindex), 0 };
-
-                        m_externStack.push_back(actionElement);
+						m_externStack.push_back({ SemanticKind::SYNTHESIZED, false, symbol });
+						m_externStack.push_back({ SemanticKind::NONTERMINAL, false, symbol });
 					}
+					else
+						m_externStack.push_back({ SemanticKind::TERMINAL, false, symbol });
 				}
 
-                if (topHasValue)
+                if (top.hasValue)
                 {
-					if (production == "+TG" || production == "-TG" || production == "*FS" || production == "/FS")
-                    {
-						m_externStack[oldTopIndex + 3].hasValue = true;
-						m_externStack[oldTopIndex + 3].value = topValue;
-                    }
-                    else
-                    {
-                        m_externStack.back().hasValue = true;
-                        m_externStack.back().value = topValue;
-                    }
+					// The inherited value is the left operand of the first binary action, if any.
+					SemanticEntry& receiver = firstBinary != std::string_view::npos ? m_externStack[firstBinary] : m_externStack.back();
+					receiver.hasValue = true;
+					receiver.value = top.value;
                 }
 			}
 			else {
+				trace(TraceEvent::FAIL, top.id, 0, m_externStack.size());
 				std::cout << "Grammar error!" << std::endl;
 				std::cout << "Parse failed." << std::endl;
 				break;
 			}
 		}
 
-		if (m_currentChar != "#")
+		if (!atEnd())
 		{
 			std::cout << "Parse failed,extra symbols appeared." << std::endl;
 		}
+		if (!accepted)
+			printErrorPosition();
+		if (!atEnd() || !m_externStack.back().is(SemanticKind::TERMINAL, m_grammar.m_endMarker))
+			traceFailure();
+		return accepted;
 	}
 
 	void LL1Parser::actionFunction(int actionindex)
 	{
-        Element& top = m_externStack.back();
-        Element& next = m_externStack[m_externStack.size() - 2];
-		if (m_externStack.size() - 3 >= 0)
-		{
-			Element& nextnext = m_externStack[m_externStack.size() - 3];
-			if (actionindex == 16)
-			{
-				nextnext.value = top.value;
-			}
-		}
-		//E->T{ 1 }G{ 2 }
-		if (actionindex == 1)
-		{
-			next.value = top.value;
-		}
-
-		if (actionindex == 2)
-		{
-			next.value = top.value;
-		}
-
-		//G-> + T{ 3 }G{ 4 }
-		if (actionindex == 3)
-		{
-			next.value = top.value + m_valueCache;
-		}
-
-		if (actionindex == 4)
-		{
-			next.value = top.value;
-		}
-		
-		//G-> - T{ 5 }G{ 6 }
-		if (actionindex == 5)
-		{
-			next.value = top.value - m_valueCache;
-		}
-		if (actionindex == 6)
-		{
-			next.value = top.value;
-		}
-
-		//G->e{7}
-		if (actionindex == 7)
-		{
-			next.value = top.value;
-		}
-
-		//T->F{8}S{9}
-		if (actionindex == 8)
-		{
-			next.value = top.value;
-		}
-		if (actionindex == 9)
-		{
-			next.value = top.value;
-		}
-
-		//S->*F{10}S{11}
-		if (actionindex == 10)
-		{
-			next.value = top.value * m_valueCache;
-		}
-		if (actionindex == 11)
-		{
-			next.value = top.value;
-		}
-
-		//S->/F{12}S{13}
-		if (actionindex == 12)
-		{
-			if (m_valueCache == 0) {
-				std::cout << "Error: Division by zero" << std::endl;
-				exit(1);
-			}
-			next.value = top.value / m_valueCache;
-		}
-
-		if (actionindex == 13)
-		{
-			next.value = top.value;
-		}
-
-		//S->e{14}
-		if (actionindex == 14)
-		{
-			next.value = top.value;
-		}
-
-		//F->n{15}
-		if (actionindex == 15)
-		{
-			next.value = top.value;
-		}
-
-		//F->(E{16}){17}
-		
-		if (actionindex == 17)
-		{
-			next.value = top.value;
-		}
-
-		next.hasValue = true;
+		const SemanticEntry& self = m_externStack.back();
+		// Terminals below the action only wait to be matched; the result skips over them.
+		size_t target = m_externStack.size() - 2;
+		while (target > 0 && m_externStack[target].kind == SemanticKind::TERMINAL)
+			target--;
+
+		// A missing value is not handed on as 0: node-building actions would read it as node 0.
+		std::uint16_t number = static_cast<std::uint16_t>(actionindex);
+		bool binary = m_registry.binary(number);
+		if (binary && (!self.hasValue || !m_operand))
+			throw ActionFailed("Missing operand for action {" + std::to_string(number) + "}");
+		if (!self.hasValue || !m_registry.bound(number))
+			return;
+
+		SemanticEntry& receiver = m_externStack[target];
+		receiver.value = m_registry.call(number, { self.value, m_operand.value_or(0), m_registry.user() });
+		receiver.hasValue = true;
+		if (binary)
+			m_operand.reset();
 	}
 }
\ No newline at end of file
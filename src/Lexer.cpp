@@ -1,38 +1,87 @@
 #include "Lexer.hpp"
 
-namespace PL0 
+namespace PL0
 {
-	Lexer::Lexer(const std::string& filename)
-		: m_line(1), m_column(0)
+	static std::string toLower(std::string_view str)
 	{
-		std::ifstream code(filename);
+		std::string lower(str);
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+		return lower;
+	}
 
-		if (!code.is_open())
-			throw OpenFileFailed(filename);
-		std::stringstream buffer;
-		buffer << code.rdbuf();
-		m_file = buffer.str();
+	Lexer::Lexer(const std::string& filename, InputMode mode)
+		: m_pos(0), m_line(1), m_column(0)
+	{
+		if (mode == InputMode::MAPPED)
+		{
+			m_mapping = MappedFile(filename);
+			m_source = m_mapping.view();
+		}
+		else
+		{
+			std::ifstream code(filename);
 
-		std::transform(m_file.begin(), m_file.end(), m_file.begin(), [](unsigned char c) { return std::tolower(c); });
+			if (!code.is_open())
+				throw OpenFileFailed(filename);
+			std::stringstream buffer;
+			buffer << code.rdbuf();
+			m_file = buffer.str();
+			m_source = m_file;
+		}
 
-		m_currentChar = getChar(m_line, m_column);
+		m_currentChar = m_source.empty() ? '\0' : m_source[0];
+	}
+
+	Lexer::Lexer(SourceText source)
+		: m_source(source.text), m_pos(0), m_line(source.firstLine), m_column(0)
+	{
+		m_currentChar = m_source.empty() ? '\0' : m_source[0];
 	}
 
 	Lexer::~Lexer() {}
 
-	bool Lexer::isKeyWords(std::string str) 
+	Lexer::Lexer(Lexer&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	Lexer& Lexer::operator=(Lexer&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		bool owned = !other.m_file.empty() && other.m_source.data() == other.m_file.data();
+		size_t length = other.m_source.size();
+		m_file = std::move(other.m_file);
+		m_mapping = std::move(other.m_mapping);
+		m_source = owned ? std::string_view(m_file).substr(0, length) : other.m_source;
+		m_lineStarts = std::move(other.m_lineStarts);
+		m_currentChar = other.m_currentChar;
+		m_pos = other.m_pos;
+		m_line = other.m_line;
+		m_column = other.m_column;
+		m_interner = other.m_interner;
+		m_diagnostics = std::move(other.m_diagnostics);
+
+		other.m_source = {};
+		other.m_currentChar = '\0';
+		other.m_pos = 0;
+		return *this;
+	}
+
+	bool Lexer::isKeyWords(std::string_view str)
 	{
-		return PL0::KeyWords.find(str)!= PL0::KeyWords.end();
+		return isKeyWordKind(lookupKeyWord(str));
 	}
 
-	bool Lexer::isOperatorWords(std::string str)
+	bool Lexer::isOperatorWords(std::string_view str)
 	{
-		return PL0::OperatorWords.find(str) != PL0::OperatorWords.end();
+		return isOperatorKind(lookupSymbol(str));
 	}
 
-	bool Lexer::isDelimiterWords(std::string str)
+	bool Lexer::isDelimiterWords(std::string_view str)
 	{
-		return PL0::DelimiterWords.find(str) != PL0::DelimiterWords.end();
+		return isDelimiterKind(lookupSymbol(str));
 	}
 
 	bool Lexer::isIdentifier(std::string str)
@@ -47,23 +96,33 @@ namespace PL0
 		return true;
 	}
 
+	void Lexer::buildLineStarts()
+	{
+		// Offset of the first character of every line, so (line, column) lookups are O(1).
+		// Built on first use, so plain lexing reads the source only once.
+		m_lineStarts.push_back(0);
+		for (size_t pos = m_source.find('\n'); pos != std::string_view::npos; pos = m_source.find('\n', pos + 1))
+			m_lineStarts.push_back(pos + 1);
+	}
+
 	char Lexer::getChar(size_t line, size_t column)
 	{
-		size_t pos = 0;
+		if (m_lineStarts.empty())
+			buildLineStarts();
 
-		for (size_t i = 0; i < line - 1; i++)
-		{
-			pos = m_file.find('\n', pos);
-			pos++;
-		}
+		if (line == 0 || line > m_lineStarts.size())
+			return '\0';
 
-		pos += column;
+		size_t pos = m_lineStarts[line - 1] + column;
 
-		return m_file[pos];
+		return pos < m_source.size() ? m_source[pos] : '\0';
 	}
 
 	void Lexer::nextChar()
 	{
+		if (m_pos >= m_source.size())
+			return;
+
 		m_column++;
 		if (m_currentChar == '\n')
 		{
@@ -71,7 +130,8 @@ namespace PL0
 			m_column = 0;
 		}
 
-		m_currentChar = getChar(m_line, m_column);
+		m_pos++;
+		m_currentChar = m_pos < m_source.size() ? m_source[m_pos] : '\0';
 	}
 
 	char Lexer::getNextChar(size_t line, size_t column)
@@ -80,129 +140,341 @@ namespace PL0
 	}
 
 
-	Token Lexer::nextToken()
+	std::string Lexer::value(const TokenView& token) const
 	{
-		skipSpace();
-		skipComment();
-		skipSpace();
+		if (token.type == TokenType::ENDOFFILE)
+			return "end of file";
+		return toLower(text(token));
+	}
 
-		if (isdigit(m_currentChar))
-			return parseNumber();
-		else if (isDelimiterWords(std::string(1, m_currentChar)))
-			return parseDelimiter();
-		else if (isOperatorWords(std::string(1, m_currentChar))||m_currentChar==':')
-			return parseOperator();
-		else if (isalpha(m_currentChar))
-			return parseKeyWordOrIdentifier();
-		else if (m_currentChar=='\0')
-			return parseEOF();
-		else return parseUnknownSymbol();
+	void Lexer::printDiagnostics(std::ostream& out)
+	{
+		m_diagnostics.render(out, m_source);
+		if (m_diagnostics.dropped() > 0)
+			out << std::format("Error: {} more errors not shown\n", m_diagnostics.dropped());
+		m_diagnostics.clear();
 	}
 
-	void Lexer::skipComment()
+	Token Lexer::nextToken()
 	{
-		if (m_currentChar == '{')
+		TokenView token = nextTokenView();
+		return { token.type, token.kind, value(token), token.number };
+	}
+
+	size_t Lexer::nextTokens(TokenBuffer& buffer, size_t maxCount)
+	{
+		if (m_source.size() > std::numeric_limits<std::uint32_t>::max())
+			throw InputTooLarge("token buffer");
+
+		size_t count = 0;
+		for (; count < maxCount; count++)
 		{
-			while (m_currentChar != '}' && m_currentChar != '\0')
-				nextChar();
-			if (m_currentChar == '\0')
-				return;
-			nextChar();
+			TokenView token = nextTokenView();
+			if (token.kind == TokenKind::ENDOFFILE)
+				break;
+
+			buffer.push_back(token, tokenValue(token));
 		}
+		return count;
 	}
 
-	void Lexer::skipSpace()
+	std::int64_t Lexer::tokenValue(const TokenView& token)
+	{
+		if (token.kind == TokenKind::NUMBER)
+			return token.number;
+		if (token.kind != TokenKind::IDENT || m_interner == nullptr)
+			return 0;
+
+		// Identifiers are case-insensitive; only mixed-case spellings pay for a lowered copy.
+		std::string_view spelling = text(token);
+		if (std::none_of(spelling.begin(), spelling.end(), [](char c) { return c >= 'A' && c <= 'Z'; }))
+			return m_interner->intern(spelling);
+		return m_interner->intern(toLower(spelling));
+	}
+
+	TokenBuffer Lexer::tokenizeAll()
 	{
-		while (m_currentChar == ' '||m_currentChar == '\n'||m_currentChar == '\t'||m_currentChar == '\r')
+		// Size the columns from the token density of what has been lexed so far rather than a fixed
+		// bytes-per-token guess, which is off by half either way between dense code and sources heavy
+		// with comments and whitespace. If the projection runs short it is redone from the longer prefix.
+		constexpr size_t sampleBytes = 1 << 16;
+		constexpr size_t sampleStep = 1 << 10;
+		TokenBuffer buffer;
+		size_t start = m_pos;
+		for (size_t batch = sampleStep; nextTokens(buffer, batch) == batch; )
 		{
-			nextChar();
+			size_t lexed = m_pos - start;
+			if (lexed < sampleBytes)
+				continue;
+
+			size_t projected = (m_source.size() - m_pos) * buffer.size() / lexed;
+			buffer.reserve(buffer.size() + projected + projected / 16 + sampleStep);
+			batch = buffer.kinds.capacity() - buffer.size();
 		}
+		return buffer;
 	}
 
-	Token Lexer::parseNumber()
+	namespace
 	{
-		std::string word;
-		while (isdigit(m_currentChar))
+		// How a stretch of source changes the "inside a { } comment" state, and its line count.
+		struct ChunkSummary
 		{
-			word += m_currentChar;
-			nextChar();
+			bool insideIfStartedOutside;
+			bool insideIfStartedInside;
+			size_t newlines;
+		};
+
+		bool endsInsideComment(std::string_view text, bool inside)
+		{
+			size_t pos = 0;
+			while ((pos = text.find(inside ? '}' : '{', pos)) != std::string_view::npos)
+			{
+				inside = !inside;
+				pos++;
+			}
+			return inside;
 		}
-	
-		if (isalpha(m_currentChar))
+
+		ChunkSummary summarizeChunk(std::string_view text)
 		{
-			while (isdigit(m_currentChar) || isalpha(m_currentChar))
+			return { endsInsideComment(text, false), endsInsideComment(text, true),
+				static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) };
+		}
+
+		// First token boundary at or after `pos`: just past the comment that contains `pos`,
+		// or else the next whitespace or comment opener, neither of which can be inside a token.
+		size_t findSafeSplit(std::string_view source, size_t pos, bool insideComment)
+		{
+			if (insideComment)
 			{
-				word += m_currentChar;
-				nextChar();
+				size_t close = source.find('}', pos);
+				return close == std::string_view::npos ? source.size() : close + 1;
 			}
-			std::cout << std::format("Error: Line {0}, {1} is not a valid identifier\n",m_line,word);
-			return { TokenType::NONE, word };  
+			while (pos < source.size() && charClass(source[pos]) != CharClass::SPACE && source[pos] != '{')
+				pos++;
+			return pos;
 		}
-			
-		return { TokenType::NUMBER, word };
 	}
 
-	Token Lexer::parseDelimiter()
+	TokenBuffer Lexer::tokenizeParallel(ThreadPool& pool)
 	{
-		std::string delimiter = std::string(1, m_currentChar);
-		nextChar();
-		return { TokenType::DELIMITER, delimiter };
+		constexpr size_t minChunkSize = 1 << 16;
+
+		if (m_source.size() > std::numeric_limits<std::uint32_t>::max())
+			throw InputTooLarge("token buffer");
+
+		// The sequential lexer stops at the first '\0', so the chunks must as well.
+		size_t begin = m_pos;
+		size_t end = std::min(m_source.find('\0', begin), m_source.size());
+		size_t chunkCount = std::min((end - begin) / minChunkSize, pool.size() * 4);
+		if (chunkCount <= 1)
+			return tokenizeAll();
+
+		std::vector<size_t> targets(chunkCount + 1);
+		for (size_t k = 0; k <= chunkCount; k++)
+			targets[k] = begin + (end - begin) * k / chunkCount;
+
+		std::vector<ChunkSummary> summaries(chunkCount);
+		pool.forEach(chunkCount, [this, &targets, &summaries](size_t k) {
+			summaries[k] = summarizeChunk(m_source.substr(targets[k], targets[k + 1] - targets[k]));
+		});
+
+		// Resolve the comment state at every target in order, then slide it to a token boundary.
+		std::vector<size_t> splits(chunkCount + 1), lines(chunkCount + 1);
+		splits[0] = begin;
+		lines[0] = m_line;
+		bool inside = false;
+		size_t line = m_line;
+		for (size_t k = 1; k <= chunkCount; k++)
+		{
+			const ChunkSummary& summary = summaries[k - 1];
+			inside = inside ? summary.insideIfStartedInside : summary.insideIfStartedOutside;
+			line += summary.newlines;
+			if (k == chunkCount)
+				break;
+
+			size_t split = findSafeSplit(m_source.substr(0, end), targets[k], inside);
+			if (split <= splits[k - 1])
+			{
+				splits[k] = splits[k - 1];
+				lines[k] = lines[k - 1];
+				continue;
+			}
+			splits[k] = split;
+			lines[k] = line + std::count(m_source.begin() + targets[k], m_source.begin() + split, '\n');
+		}
+		splits[chunkCount] = end;
+
+		std::vector<TokenBuffer> buffers(chunkCount);
+		std::vector<Diagnostics> errors(chunkCount);
+		pool.forEach(chunkCount, [this, &splits, &lines, &buffers, &errors](size_t k) {
+			Lexer chunk(SourceText{ m_source.substr(splits[k], splits[k + 1] - splits[k]), lines[k] });
+			chunk.diagnostics().setLimit(m_diagnostics.limit());
+			buffers[k] = chunk.tokenizeAll();
+			for (auto& offset : buffers[k].offsets)
+				offset += static_cast<std::uint32_t>(splits[k]);
+			errors[k] = std::move(chunk.diagnostics());
+		});
+
+		size_t total = 0;
+		for (auto& buffer : buffers)
+			total += buffer.size();
+
+		TokenBuffer result;
+		result.reserve(total);
+		for (size_t k = 0; k < chunkCount; k++)
+		{
+			result.kinds.insert(result.kinds.end(), buffers[k].kinds.begin(), buffers[k].kinds.end());
+			result.offsets.insert(result.offsets.end(), buffers[k].offsets.begin(), buffers[k].offsets.end());
+			result.lengths.insert(result.lengths.end(), buffers[k].lengths.begin(), buffers[k].lengths.end());
+			result.values.insert(result.values.end(), buffers[k].values.begin(), buffers[k].values.end());
+			m_diagnostics.append(errors[k], splits[k]);
+		}
+
+		// Chunks lex without the interner, which is single-threaded; interning the identifiers here,
+		// in order, hands out the same ids as a sequential pass.
+		if (m_interner != nullptr)
+			for (size_t i = 0; i < result.size(); i++)
+				if (result.kinds[i] == TokenKind::IDENT)
+					result.values[i] = tokenValue(result[i]);
+
+		advanceTo(end, line - m_line);
+		return result;
 	}
 
-	Token Lexer::parseOperator()
+	TokenView Lexer::nextTokenView()
 	{
-		std::string op,op2;
-		op = m_currentChar; 
-		nextChar();
-		op2 = op + m_currentChar;
-		if (isOperatorWords(op2))
+		skipSpace();
+		while (m_currentChar == '{')
 		{
-			nextChar();
-			return { TokenType::OPERATOR, op2 };
+			skipComment();
+			skipSpace();
 		}
-		else if (isOperatorWords(op))
+
+		switch (charClass(m_currentChar))
 		{
-			return { TokenType::OPERATOR, op };
-		}
-		else  {			
-			std::cout<<std::format("Error: Line {0}, {1} is not a valid operator\n",m_line,op);
-			return { TokenType::NONE, op};
+		case CharClass::DIGIT:
+			return parseNumber();
+		case CharClass::SYMBOL:
+			return parseSymbol();
+		case CharClass::LETTER:
+			return parseKeyWordOrIdentifier();
+		case CharClass::END:
+			return parseEOF();
+		default:
+			return parseUnknownSymbol();
 		}
 	}
 
-	Token Lexer::parseKeyWordOrIdentifier()
+	void Lexer::advanceTo(size_t pos, size_t newlines)
 	{
-		std::string word;
-		while (isalpha(m_currentChar))
+		if (newlines == 0)
+			m_column += pos - m_pos;
+		else
 		{
-			word += m_currentChar;
-			nextChar();
+			m_line += newlines;
+			m_column = pos - (m_source.rfind('\n', pos - 1) + 1);
 		}
-		if (isKeyWords(word))
-			return { TokenType::KEYWORD, word };
 
-		while (isalpha(m_currentChar) || isdigit(m_currentChar))
+		m_pos = pos;
+		m_currentChar = m_pos < m_source.size() ? m_source[m_pos] : '\0';
+	}
+
+	void Lexer::skipComment()
+	{
+		if (m_currentChar == '{')
 		{
-			word += m_currentChar;
+			size_t newlines = 0;
+			size_t end = findCommentEnd(m_source.data(), m_pos + 1, m_source.size(), newlines);
+			advanceTo(end, newlines);
+			if (m_currentChar == '\0')
+				return;
 			nextChar();
 		}
-		return { TokenType::IDENTIFIER, word };
 	}
 
-	Token Lexer::parseUnknownSymbol() 
+	void Lexer::skipSpace()
 	{
-		std::string unknown;
-		if (!isDelimiterWords(std::string(1, m_currentChar)) && !isalpha(m_currentChar) && !isdigit(m_currentChar))
+		if (charClass(m_currentChar) != CharClass::SPACE)
+			return;
+
+		size_t newlines = 0;
+		size_t end = skipWhitespace(m_source.data(), m_pos, m_source.size(), newlines);
+		advanceTo(end, newlines);
+	}
+
+	TokenView Lexer::parseNumber()
+	{
+		// Digits never span lines, so scan them straight off the source, decoding as we go. A value
+		// past INT64_MAX is reported once and saturates instead of wrapping.
+		constexpr std::int64_t max = std::numeric_limits<std::int64_t>::max();
+		size_t start = m_pos, end = m_pos;
+		std::int64_t number = 0;
+		bool overflow = false;
+		for (; end < m_source.size() && charClass(m_source[end]) == CharClass::DIGIT; end++)
+		{
+			int digit = m_source[end] - '0';
+			overflow |= number > (max - digit) / 10;
+			number = overflow ? max : number * 10 + digit;
+		}
+		advanceTo(end, 0);
+
+		if (charClass(m_currentChar) == CharClass::LETTER)
 		{
-			unknown += m_currentChar;
+			while (charClass(m_currentChar) == CharClass::DIGIT || charClass(m_currentChar) == CharClass::LETTER)
+				nextChar();
+			m_diagnostics.report(DiagnosticCode::INVALID_IDENTIFIER, m_line, start, m_pos - start);
+			return { TokenType::NONE, TokenKind::NONE, start, m_pos - start };
+		}
+
+		if (overflow)
+			m_diagnostics.report(DiagnosticCode::NUMBER_TOO_LARGE, m_line, start, m_pos - start);
+		return { TokenType::NUMBER, TokenKind::NUMBER, start, m_pos - start, number };
+	}
+
+	TokenView Lexer::parseSymbol()
+	{
+		// Longest match through the operator/delimiter DFA; ':' alone is the only dead end.
+		size_t start = m_pos;
+		std::uint8_t state = 0;
+		for (std::uint8_t next; (next = SymbolTable.next[state][static_cast<unsigned char>(m_currentChar)]) != 0; state = next)
 			nextChar();
+
+		TokenKind kind = SymbolTable.accept[state];
+		if (kind == TokenKind::NONE)
+		{
+			m_diagnostics.report(DiagnosticCode::INVALID_OPERATOR, m_line, start, m_pos - start);
+			return { TokenType::NONE, TokenKind::NONE, start, m_pos - start };
 		}
-		std::cout << std::format("Error: Line {0}, {1} is an unknown symbol\n",m_line,unknown);
-		return { TokenType::NONE, unknown };
+		if (isOperatorKind(kind))
+			return { TokenType::OPERATOR, kind, start, m_pos - start };
+		return { TokenType::DELIMITER, kind, start, m_pos - start };
+	}
+
+	TokenView Lexer::parseKeyWordOrIdentifier()
+	{
+		size_t start = m_pos;
+		while (charClass(m_currentChar) == CharClass::LETTER)
+			nextChar();
+		TokenKind keyword = lookupKeyWord(m_source.substr(start, m_pos - start));
+		if (keyword != TokenKind::NONE)
+			return { TokenType::KEYWORD, keyword, start, m_pos - start };
+
+		while (charClass(m_currentChar) == CharClass::LETTER || charClass(m_currentChar) == CharClass::DIGIT)
+			nextChar();
+		return { TokenType::IDENTIFIER, TokenKind::IDENT, start, m_pos - start };
+	}
+
+	TokenView Lexer::parseUnknownSymbol()
+	{
+		size_t start = m_pos;
+		nextChar();
+		m_diagnostics.report(DiagnosticCode::UNKNOWN_SYMBOL, m_line, start, m_pos - start);
+		return { TokenType::NONE, TokenKind::NONE, start, m_pos - start };
 	}
 
-	Token Lexer::parseEOF()
+	TokenView Lexer::parseEOF()
 	{
-		return { TokenType::ENDOFFILE, "end of file" };
+		return { TokenType::ENDOFFILE, TokenKind::ENDOFFILE, m_source.size(), 0 };
 	}
 }
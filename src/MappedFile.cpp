@@ -0,0 +1,130 @@
+#include "MappedFile.hpp"
+#include "Exceptions.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PL0
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(const std::string& filename)
+	{
+		HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw OpenFileFailed(filename);
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			throw OpenFileFailed(filename);
+		}
+		m_fileHandle = file;
+		m_size = static_cast<size_t>(size.QuadPart);
+		if (m_size == 0)
+			return;
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			release();
+			throw OpenFileFailed(filename);
+		}
+		m_mappingHandle = mapping;
+
+		m_data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_data == nullptr)
+		{
+			release();
+			throw OpenFileFailed(filename);
+		}
+	}
+
+	void MappedFile::release()
+	{
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		if (m_mappingHandle != nullptr)
+			CloseHandle(m_mappingHandle);
+		if (m_fileHandle != nullptr)
+			CloseHandle(m_fileHandle);
+		m_data = nullptr;
+		m_size = 0;
+		m_mappingHandle = nullptr;
+		m_fileHandle = nullptr;
+	}
+#else
+	MappedFile::MappedFile(const std::string& filename)
+	{
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw OpenFileFailed(filename);
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
+		{
+			::close(fd);
+			throw OpenFileFailed(filename);
+		}
+		m_size = static_cast<size_t>(st.st_size);
+		if (m_size == 0)
+		{
+			::close(fd);
+			return;
+		}
+
+		void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED)
+		{
+			m_size = 0;
+			throw OpenFileFailed(filename);
+		}
+		::madvise(data, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const char*>(data);
+	}
+
+	void MappedFile::release()
+	{
+		if (m_data != nullptr)
+			::munmap(const_cast<char*>(m_data), m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+#endif
+
+	MappedFile::~MappedFile()
+	{
+		release();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+			m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+			m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+#endif
+		}
+		return *this;
+	}
+}
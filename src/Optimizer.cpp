@@ -11,6 +11,7 @@ namespace PL0
         // Case1: op, y, z, x
         // Case2: op, y, _, x
         // Case3: = , y, _, x
+        const SymbolId assign = m_names.intern("=");
 
         // Traverse every quad in `quads`:
         for (auto [op, y, z, x] : quads) {
@@ -20,7 +21,7 @@ namespace PL0
             // If `nodeY` exists (can be mapped from `y`):
             if (isNodeExists(y)) {
                 // Get `nodeY` directly from the map.
-                nodeY = m_varName2nodePtr[y];
+                nodeY = nodeOf(y);
             }
             // Else if `nodeY` does not exist (cannot be mapped from `y`):
             else {
@@ -28,18 +29,18 @@ namespace PL0
                 nodeY = std::make_shared<Node>();
                 nodeY->varNames.push_back(y);
                 nodeY->value = y;
-                nodeY->type = string_to_number<double>(y) ? Node::Type::CONST : Node::Type::VAR;
+                nodeY->type = isConstant<double>(y) ? Node::Type::CONST : Node::Type::VAR;
                 mapVarNameToNode(y, nodeY);
                 isNodeYNew = true;
             }
 
             NodePtr nodeZ = nullptr;
             // Skip if `z` is empty.
-            if (!z.empty()) {
+            if (z != Interner::Empty) {
                 // If `nodeZ` exists (can be mapped from `z`):
                 if (isNodeExists(z)) {
                     // Get `nodeZ` directly from the map.
-                    nodeZ = m_varName2nodePtr[z];
+                    nodeZ = nodeOf(z);
                 }
                 // Else if `nodeZ` does not exist (cannot be mapped from `z`):
                 else {
@@ -47,7 +48,7 @@ namespace PL0
                     nodeZ = std::make_shared<Node>();
                     nodeZ->varNames.push_back(z);
                     nodeZ->value = z;
-                    nodeZ->type = string_to_number<double>(z) ? Node::Type::CONST : Node::Type::VAR;
+                    nodeZ->type = isConstant<double>(z) ? Node::Type::CONST : Node::Type::VAR;
                     mapVarNameToNode(z, nodeZ);
                     isNodeZNew = true;
                 }
@@ -57,16 +58,16 @@ namespace PL0
             NodePtr nodeN = nullptr;
 
             // ------ Case1: op, y, z, x ------
-            if (!y.empty() && !z.empty()) {
+            if (y != Interner::Empty && z != Interner::Empty) {
                 // If `y` and `z` are both constants
                 if (nodeY->type == Node::Type::CONST && nodeZ->type == Node::Type::CONST) {
-                    std::string p =
-                        std::format("{}", calculate<double>(op, nodeY->value, nodeZ->value));
+                    SymbolId p = m_names.intern(
+                        std::format("{}", calculate<double>(op, nodeY->value, nodeZ->value)));
 
                     NodePtr nodeP = nullptr;
                     // If `nodeP` exists (can be mapped from `p`):
-                    if (m_varName2nodePtr.contains(p)) {
-                        nodeP = m_varName2nodePtr[p];
+                    if (isNodeExists(p)) {
+                        nodeP = nodeOf(p);
                     }
                     // Else if `nodeP` does not exist (cannot be mapped from `p`):
                     else {
@@ -80,10 +81,10 @@ namespace PL0
                     // If `nodeY` (or `nodeZ`) is newly created, erase the map.
                     // After erase, `isNodeExists(y)` (or `isNodeExists(z)`) would return false.
                     if (isNodeYNew) {
-                        m_varName2nodePtr.erase(y);
+                        nodeOf(y) = nullptr;
                     }
                     if (isNodeZNew) {
-                        m_varName2nodePtr.erase(z);
+                        nodeOf(z) = nullptr;
                     }
 
                     // Assign `nodeP` to `nodeN`.
@@ -95,8 +96,8 @@ namespace PL0
                     // Find a node whose value is `op` and whose children are `nodeY` and `nodeZ`.
                     for (auto node : m_nodes) {
                         if (node->children.size() == 2 && node->value == op &&
-                            node->children[0] == m_varName2nodePtr[y] &&
-                            node->children[1] == m_varName2nodePtr[z]) {
+                            node->children[0] == nodeOf(y) &&
+                            node->children[1] == nodeOf(z)) {
                             // If such a node exists, assign it to `nodeN` and break the loop.
                             nodeN = node;
                             break;
@@ -116,15 +117,15 @@ namespace PL0
             }
 
             // ------ Case2: op, y, _, x ------
-            else if (z.empty() && op != "=") {
+            else if (z == Interner::Empty && op != assign) {
                 throw "Unary operation is not supported.";
             }
 
             // ------ Case3: = , y, _, x ------
-            else if (z.empty() && op == "=") {
+            else if (z == Interner::Empty && op == assign) {
                 if (isNodeYNew) {
                     // Fuck off, constant shit.
-                    m_varName2nodePtr.erase(y);
+                    nodeOf(y) = nullptr;
                     nodeY->varNames.pop_back();
                 }
                 nodeN = nodeY;
@@ -138,9 +139,8 @@ namespace PL0
             nodeN->varNames.push_back(x);
 
             // Try to find where `x` is in map
-            auto nodeX_it_map = m_varName2nodePtr.find(x);
-            if (nodeX_it_map != m_varName2nodePtr.end()) {
-                NodePtr nodeX = nodeX_it_map->second;
+            if (isNodeExists(x)) {
+                NodePtr nodeX = nodeOf(x);
                 auto varNameX_it = std::ranges::find(nodeX->varNames, x);
                 // @note Check for iterators's validation is skipped because there must be
                 //       a map from `x` to `nodeX` and `x` must be in `nodeX->varNames`.
@@ -148,7 +148,7 @@ namespace PL0
             }
 
             // Replace original `x` or add new `x`.
-            m_varName2nodePtr[x] = nodeN;
+            nodeOf(x) = nodeN;
             if (!std::ranges::contains(m_nodes, nodeN)) {
                 m_nodes.push_back(nodeN);
             }
@@ -157,6 +157,7 @@ namespace PL0
 
     std::vector<Quadruple> Optimizer::colloectQuadruples()
     {
+        const SymbolId assign = m_names.intern("=");
         std::vector<Quadruple> result;
         for (const auto& node : m_nodes) {
             auto varNameIter = node->varNames.begin();
@@ -164,23 +165,23 @@ namespace PL0
                 continue;
             }
             if (node->type == Node::Type::CONST) {
-                result.emplace_back("=", node->value, "", *varNameIter);
+                result.emplace_back(assign, node->value, Interner::Empty, *varNameIter);
             }
             else {
-                std::string arg1 = node->children[0]->type == Node::Type::CONST
+                SymbolId arg1 = node->children[0]->type == Node::Type::CONST
                     ? node->children[0]->value
                     : node->children[0]->varNames[0];
-                std::string arg2 = node->children[1]->type == Node::Type::CONST
+                SymbolId arg2 = node->children[1]->type == Node::Type::CONST
                     ? node->children[1]->value
                     : node->children[1]->varNames[0];
                 result.emplace_back(node->value, arg1, arg2, *varNameIter);
             }
             for (varNameIter += 1; varNameIter != node->varNames.end(); ++varNameIter) {
                 if (node->type == Node::Type::CONST) {
-                    result.emplace_back("=", node->value, "", *varNameIter);
+                    result.emplace_back(assign, node->value, Interner::Empty, *varNameIter);
                 }
                 else {
-                    result.emplace_back("=", node->varNames[0], "", *varNameIter);
+                    result.emplace_back(assign, node->varNames[0], Interner::Empty, *varNameIter);
                 }
             }
         }
@@ -192,9 +193,9 @@ namespace PL0
      *
      * @note 1 var name maps to 1 node; 1 node containes 1 or more var names.
      */
-    bool Optimizer::isNodeExists(std::string varName)
+    bool Optimizer::isNodeExists(SymbolId varName)
     {
-        return m_varName2nodePtr.contains(varName);
+        return varName < m_varName2nodePtr.size() && m_varName2nodePtr[varName] != nullptr;
     }
 
     /**
@@ -204,9 +205,22 @@ namespace PL0
      *       By calling this function, the map from `x` to `nodeN` is created, and
      *       `isNodeExists(x)` would become true.
      */
-    void Optimizer::mapVarNameToNode(std::string x, NodePtr nodeN)
+    void Optimizer::mapVarNameToNode(SymbolId x, NodePtr nodeN)
     {
-        m_varName2nodePtr[x] = nodeN;
+        nodeOf(x) = nodeN;
+    }
+
+    /**
+     * @brief The node `x` maps to, or a null pointer if there is none.
+     *
+     * @note Symbol ids are dense, so the map is a table indexed by id that grows on demand.
+     */
+    Optimizer::NodePtr& Optimizer::nodeOf(SymbolId x)
+    {
+        if (x >= m_varName2nodePtr.size()) {
+            m_varName2nodePtr.resize(std::max<size_t>(x + 1, m_names.size()));
+        }
+        return m_varName2nodePtr[x];
     }
 
 }  // namespace plazy
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "ParserGenerator.hpp"
+#include <format>
+#include <sstream>
+
+namespace PL0
+{
+	ParserGenerator::ParserGenerator(const std::string& rules, const std::string& lsdt)
+		: m_grammar(rules), m_sources(rules), m_actions(m_grammar)
+	{
+		// The generated code switches on terminalOf(), which only knows the compact spelling.
+		if (m_grammar.named())
+			throw NotImmeplemented("recursive-descent generation for named grammars");
+		if (!lsdt.empty())
+		{
+			m_actions.read(m_grammar, lsdt);
+			m_sources += " and " + lsdt;
+			m_semantic = true;
+			m_actionCode = expressionActions();
+		}
+	}
+
+	std::map<int, std::string> ParserGenerator::expressionActions()
+	{
+		// The actions of test/test4/L-SDT.txt, as ActionRegistry::expression() binds them, with the
+		// same overflow checks.
+		auto checked = [](std::string_view action) {
+			return std::format("if (std::optional<std::int64_t> result = evaluateBuiltin(BuiltinAction::{}, $$, $1))\n\t$$ = *result;\n"
+				"else\n\tfail(\"Error: Integer overflow\");", action);
+		};
+		return {
+			{ 1, "$$ = $1;" },                  // E->T{1}G{2}
+			{ 2, "$$ = $1;" },
+			{ 3, checked("ADD") },              // G->+T{3}G{4}
+			{ 4, "$$ = $1;" },
+			{ 5, checked("SUB") },              // G->-T{5}G{6}
+			{ 6, "$$ = $1;" },
+			{ 7, "" },                          // G->e{7}
+			{ 8, "$$ = $1;" },                  // T->F{8}S{9}
+			{ 9, "$$ = $1;" },
+			{ 10, checked("MUL") },             // S->*F{10}S{11}
+			{ 11, "$$ = $1;" },
+			{ 12, "if ($1 == 0)\n\tfail(\"Error: Division by zero\");\n" + checked("DIV") },  // S->/F{12}S{13}
+			{ 13, "$$ = $1;" },
+			{ 14, "" },                         // S->e{14}
+			{ 15, "$$ = $1;" },                 // F->n{15}
+			{ 16, "$$ = $1;" },                 // F->(E{16}){17}
+			{ 17, "" }
+		};
+	}
+
+	std::string ParserGenerator::actionCode(int number, const std::string& previous) const
+	{
+		auto code = m_actionCode.find(number);
+		if (code == m_actionCode.end())
+			throw NotImmeplemented(std::format("semantic action {{{}}}", number));
+
+		std::string text;
+		for (size_t i = 0; i < code->second.size(); i++)
+		{
+			if (code->second.compare(i, 2, "$$") == 0)
+			{
+				text += "value";
+				i++;
+			}
+			else if (code->second.compare(i, 2, "$1") == 0)
+			{
+				text += previous;
+				i++;
+			}
+			else
+				text += code->second[i];
+		}
+		return text;
+	}
+
+	void ParserGenerator::emitRule(std::ostream& out, int rule) const
+	{
+		const std::string indent = "\t\t\t\t";
+		std::string_view right = m_grammar.rightSide(rule);
+		out << indent << "// " << m_grammar.m_Rules[rule] << "\n";
+
+		for (size_t i = 0; i < right.size(); i++)
+		{
+			char symbol = right[i];
+			std::uint16_t action = m_actions.after(rule, i);
+			std::string code = action == ActionTable::None ? "" : actionCode(action, "$1");
+			bool needsValue = code.find("$1") != std::string::npos;
+			std::string previous = "0";
+
+			if (m_grammar.isNonterminal(m_grammar.symbolOf(symbol)))
+			{
+				std::string call = m_semantic ? std::format("parse{}(value)", symbol) : std::format("parse{}()", symbol);
+				if (needsValue)
+				{
+					previous = std::format("v{}", i + 1);
+					out << indent << "std::int64_t " << previous << " = " << call << ";\n";
+				}
+				else
+					out << indent << call << ";\n";
+			}
+			else if (symbol != 'e')
+			{
+				if (needsValue && symbol == 'n')
+				{
+					previous = std::format("v{}", i + 1);
+					out << indent << "std::int64_t " << previous << " = number();\n";
+				}
+				out << indent << "match('" << symbol << "');\n";
+			}
+
+			if (action == ActionTable::None)
+				continue;
+			std::string text = actionCode(action, previous);
+			out << indent << "// {" << action << "}\n";
+			std::istringstream lines(text);
+			for (std::string line; std::getline(lines, line); )
+				out << indent << line << "\n";
+		}
+	}
+
+	void ParserGenerator::emit(std::ostream& out, const std::string& className) const
+	{
+		const char* valueType = m_semantic ? "std::int64_t" : "void";
+
+		out << "// Generated by ParserGenerator from " << m_sources << "; do not edit.\n";
+		out << "#pragma once\n";
+		out << "#include \"LL1Parser.hpp\"\n";
+		out << "#include <cstdint>\n";
+		out << "#include <format>\n";
+		out << "#include <optional>\n";
+		out << "#include <string>\n\n";
+		out << "namespace PL0::Generated\n{\n";
+		out << "\tclass " << className << "\n\t{\n\tpublic:\n";
+
+		// Entry point.
+		out << "\t\tParseResult parse(const TokenBuffer& tokens" << (m_semantic ? ", std::int64_t* value = nullptr" : "") << ")\n";
+		out << "\t\t{\n";
+		out << "\t\t\tm_tokens = &tokens;\n";
+		out << "\t\t\tm_position = 0;\n";
+		out << "\t\t\tload();\n";
+		out << "\t\t\ttry\n\t\t\t{\n";
+		if (m_semantic)
+			out << "\t\t\t\tstd::int64_t result = parse" << m_grammar.m_Vn[0] << "(0);\n";
+		else
+			out << "\t\t\t\tparse" << m_grammar.m_Vn[0] << "();\n";
+		out << "\t\t\t\tif (m_lookahead != '#')\n";
+		out << "\t\t\t\t\treturn { false, m_position, \"Parse failed,extra symbols appeared.\" };\n";
+		if (m_semantic)
+			out << "\t\t\t\tif (value != nullptr)\n\t\t\t\t\t*value = result;\n";
+		out << "\t\t\t\treturn { true, 0, \"Parse successfully!\" };\n";
+		out << "\t\t\t}\n";
+		out << "\t\t\tcatch (const Failure& failure)\n\t\t\t{\n";
+		out << "\t\t\t\treturn { false, failure.token, failure.message };\n";
+		out << "\t\t\t}\n";
+		out << "\t\t}\n\n";
+
+		// Token access.
+		out << "\tprivate:\n";
+		out << "\t\tstruct Failure\n\t\t{\n\t\t\tsize_t token;\n\t\t\tstd::string message;\n\t\t};\n\n";
+		out << "\t\tvoid load()\n\t\t{\n";
+		out << "\t\t\tm_lookahead = m_position < m_tokens->size() ? terminalOf(m_tokens->kinds[m_position]) : '#';\n";
+		out << "\t\t}\n\n";
+		out << "\t\tvoid match(char terminal)\n\t\t{\n";
+		out << "\t\t\tif (m_lookahead != terminal)\n";
+		out << "\t\t\t\tfail(std::format(\"Signal {} not found in expression\", terminal));\n";
+		out << "\t\t\tm_position++;\n";
+		out << "\t\t\tload();\n";
+		out << "\t\t}\n\n";
+		if (m_semantic)
+			out << "\t\tstd::int64_t number() const { return m_tokens->values[m_position]; }\n\n";
+		out << "\t\t[[noreturn]] void fail(std::string message)\n\t\t{\n";
+		out << "\t\t\tthrow Failure{ m_position, std::move(message) };\n";
+		out << "\t\t}\n";
+
+		// One function per nonterminal; rules predicted by several terminals share a case.
+		for (size_t id = 0; id < m_grammar.m_Vn.size(); id++)
+		{
+			const std::string& nonterminal = m_grammar.m_Vn[id];
+			out << "\n\t\t" << valueType << " parse" << nonterminal << "(" << (m_semantic ? "std::int64_t inherited" : "") << ")\n";
+			out << "\t\t{\n";
+			if (m_semantic)
+				out << "\t\t\tstd::int64_t value = inherited;\n";
+			out << "\t\t\tswitch (m_lookahead)\n\t\t\t{\n";
+
+			std::map<int, std::vector<char>> cases;
+			for (size_t terminal = m_grammar.m_Vn.size(); terminal < m_grammar.m_symbols.size(); terminal++)
+			{
+				int rule = m_grammar.predict(static_cast<GrammarSymbol>(id), static_cast<GrammarSymbol>(terminal));
+				if (rule != Grammar::NoProduction)
+					cases[rule].push_back(m_grammar.m_symbols[terminal][0]);
+			}
+			for (auto& [rule, terminals] : cases)
+			{
+				for (char terminal : terminals)
+					out << "\t\t\tcase '" << (terminal == '\'' || terminal == '\\' ? "\\" : "") << terminal << "':\n";
+				out << "\t\t\t{\n";
+				emitRule(out, rule);
+				out << "\t\t\t\tbreak;\n";
+				out << "\t\t\t}\n";
+			}
+			out << "\t\t\tdefault:\n";
+			out << "\t\t\t\tfail(std::format(\"Error: No production found for " << nonterminal << " and {}\", m_lookahead));\n";
+			out << "\t\t\t}\n";
+			if (m_semantic)
+				out << "\t\t\treturn value;\n";
+			out << "\t\t}\n";
+		}
+
+		out << "\n\tprivate:\n";
+		out << "\t\tconst TokenBuffer* m_tokens = nullptr;\n";
+		out << "\t\tsize_t m_position = 0;\n";
+		out << "\t\tchar m_lookahead = '#';\n";
+		out << "\t};\n}\n";
+	}
+}
@@ -0,0 +1,198 @@
+#include "Scan.hpp"
+#include <bit>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PL0_SCAN_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(PL0_SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PL0_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PL0_TARGET_AVX2
+#endif
+
+namespace PL0
+{
+	namespace
+	{
+		using ScanFunction = size_t(*)(const char*, size_t, size_t, size_t&);
+
+		bool isWhitespace(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+		}
+
+		size_t skipWhitespaceScalar(const char* data, size_t pos, size_t size, size_t& newlines)
+		{
+			for (; pos < size && isWhitespace(data[pos]); pos++)
+				newlines += data[pos] == '\n';
+			return pos;
+		}
+
+		size_t findCommentEndScalar(const char* data, size_t pos, size_t size, size_t& newlines)
+		{
+			for (; pos < size && data[pos] != '}' && data[pos] != '\0'; pos++)
+				newlines += data[pos] == '\n';
+			return pos;
+		}
+
+#ifdef PL0_SCAN_X86
+		// Newlines among the first `count` bytes of a block whose '\n' bitmask is `newlineMask`.
+		inline size_t newlinesBefore(std::uint32_t newlineMask, unsigned count)
+		{
+			std::uint32_t below = count >= 32 ? ~0u : (1u << count) - 1;
+			return static_cast<size_t>(std::popcount(newlineMask & below));
+		}
+
+		size_t skipWhitespaceSSE2(const char* data, size_t pos, size_t size, size_t& newlines)
+		{
+			const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+			const __m128i cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n');
+			for (; pos + 16 <= size; pos += 16)
+			{
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+				__m128i isLf = _mm_cmpeq_epi8(block, lf);
+				__m128i isSpace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+					_mm_or_si128(_mm_cmpeq_epi8(block, cr), isLf));
+				std::uint32_t lfMask = static_cast<std::uint32_t>(_mm_movemask_epi8(isLf));
+				std::uint32_t stopMask = ~static_cast<std::uint32_t>(_mm_movemask_epi8(isSpace)) & 0xFFFF;
+				if (stopMask != 0)
+				{
+					unsigned stop = static_cast<unsigned>(std::countr_zero(stopMask));
+					newlines += newlinesBefore(lfMask, stop);
+					return pos + stop;
+				}
+				newlines += static_cast<size_t>(std::popcount(lfMask));
+			}
+			return skipWhitespaceScalar(data, pos, size, newlines);
+		}
+
+		size_t findCommentEndSSE2(const char* data, size_t pos, size_t size, size_t& newlines)
+		{
+			const __m128i close = _mm_set1_epi8('}'), nul = _mm_setzero_si128(), lf = _mm_set1_epi8('\n');
+			for (; pos + 16 <= size; pos += 16)
+			{
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+				std::uint32_t lfMask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, lf)));
+				std::uint32_t stopMask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+					_mm_or_si128(_mm_cmpeq_epi8(block, close), _mm_cmpeq_epi8(block, nul))));
+				if (stopMask != 0)
+				{
+					unsigned stop = static_cast<unsigned>(std::countr_zero(stopMask));
+					newlines += newlinesBefore(lfMask, stop);
+					return pos + stop;
+				}
+				newlines += static_cast<size_t>(std::popcount(lfMask));
+			}
+			return findCommentEndScalar(data, pos, size, newlines);
+		}
+
+		PL0_TARGET_AVX2 size_t skipWhitespaceAVX2(const char* data, size_t pos, size_t size, size_t& newlines)
+		{
+			const __m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+			const __m256i cr = _mm256_set1_epi8('\r'), lf = _mm256_set1_epi8('\n');
+			for (; pos + 32 <= size; pos += 32)
+			{
+				__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+				__m256i isLf = _mm256_cmpeq_epi8(block, lf);
+				__m256i isSpace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+					_mm256_or_si256(_mm256_cmpeq_epi8(block, cr), isLf));
+				std::uint32_t lfMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(isLf));
+				std::uint32_t stopMask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(isSpace));
+				if (stopMask != 0)
+				{
+					unsigned stop = static_cast<unsigned>(std::countr_zero(stopMask));
+					newlines += newlinesBefore(lfMask, stop);
+					return pos + stop;
+				}
+				newlines += static_cast<size_t>(std::popcount(lfMask));
+			}
+			return skipWhitespaceSSE2(data, pos, size, newlines);
+		}
+
+		PL0_TARGET_AVX2 size_t findCommentEndAVX2(const char* data, size_t pos, size_t size, size_t& newlines)
+		{
+			const __m256i close = _mm256_set1_epi8('}'), nul = _mm256_setzero_si256(), lf = _mm256_set1_epi8('\n');
+			for (; pos + 32 <= size; pos += 32)
+			{
+				__m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+				std::uint32_t lfMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, lf)));
+				std::uint32_t stopMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+					_mm256_or_si256(_mm256_cmpeq_epi8(block, close), _mm256_cmpeq_epi8(block, nul))));
+				if (stopMask != 0)
+				{
+					unsigned stop = static_cast<unsigned>(std::countr_zero(stopMask));
+					newlines += newlinesBefore(lfMask, stop);
+					return pos + stop;
+				}
+				newlines += static_cast<size_t>(std::popcount(lfMask));
+			}
+			return findCommentEndSSE2(data, pos, size, newlines);
+		}
+
+		bool cpuHasAVX2()
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif
+
+		struct ScanFunctions
+		{
+			ScanLevel level;
+			ScanFunction skipWhitespace;
+			ScanFunction findCommentEnd;
+		};
+
+		ScanFunctions selectScanFunctions()
+		{
+#ifdef PL0_SCAN_X86
+			if (cpuHasAVX2())
+				return { ScanLevel::AVX2, skipWhitespaceAVX2, findCommentEndAVX2 };
+			return { ScanLevel::SSE2, skipWhitespaceSSE2, findCommentEndSSE2 };
+#else
+			return { ScanLevel::SCALAR, skipWhitespaceScalar, findCommentEndScalar };
+#endif
+		}
+
+		// Chosen on first use rather than at static initialisation, so lexing from another
+		// translation unit's static initialisers never finds the table still empty.
+		const ScanFunctions& selected()
+		{
+			static const ScanFunctions functions = selectScanFunctions();
+			return functions;
+		}
+	}
+
+	ScanLevel scanLevel()
+	{
+		return selected().level;
+	}
+
+	size_t skipWhitespace(const char* data, size_t pos, size_t size, size_t& newlines)
+	{
+		return selected().skipWhitespace(data, pos, size, newlines);
+	}
+
+	size_t findCommentEnd(const char* data, size_t pos, size_t size, size_t& newlines)
+	{
+		return selected().findCommentEnd(data, pos, size, newlines);
+	}
+}
@@ -0,0 +1,195 @@
+#include "StreamLexer.hpp"
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace PL0
+{
+	namespace
+	{
+		// A byte that always ends the token it belongs to, so a cut right after it cannot split a token.
+		// ':', '<' and '>' are missing because '=' may follow them.
+		constexpr bool endsToken(char c)
+		{
+			return charClass(c) == CharClass::SPACE || std::string_view("+-*/=#(),;.").find(c) != std::string_view::npos;
+		}
+	}
+
+	StreamLexer::StreamLexer(std::istream& in, size_t bufferSize)
+		: m_in(&in), m_buffer(std::make_unique<char[]>(bufferSize)), m_capacity(bufferSize)
+	{
+	}
+
+	StreamLexer::StreamLexer(int fd, size_t bufferSize)
+		: m_fd(fd), m_buffer(std::make_unique<char[]>(bufferSize)), m_capacity(bufferSize)
+	{
+	}
+
+	size_t StreamLexer::read(char* data, size_t size)
+	{
+		if (m_in != nullptr)
+		{
+			m_in->read(data, static_cast<std::streamsize>(size));
+			return static_cast<size_t>(m_in->gcount());
+		}
+
+		// A descriptor returns whatever is available, so tokens flow before a pipe's writer is done.
+		while (true)
+		{
+#ifdef _WIN32
+			int count = _read(m_fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+			ssize_t count = ::read(m_fd, data, size);
+#endif
+			if (count >= 0)
+				return static_cast<size_t>(count);
+			if (errno != EINTR)
+				throw OpenFileFailed("file descriptor " + std::to_string(m_fd));
+		}
+	}
+
+	void StreamLexer::discard(size_t count)
+	{
+		char* data = m_buffer.get();
+		m_line += std::count(data, data + count, '\n');
+		std::memmove(data, data + count, m_size - count);
+		m_base += count;
+		m_size -= count;
+	}
+
+	bool StreamLexer::refill()
+	{
+		// The window's lexer has read up to its end, so it already knows the line there. Its errors
+		// are rendered now, if anyone asked for them, while their text is still buffered.
+		char* data = m_buffer.get();
+		if (m_lexer)
+		{
+			if (m_errorStream != nullptr)
+				m_lexer->diagnostics().render(*m_errorStream, std::string_view(data, m_window));
+			m_diagnostics.append(m_lexer->diagnostics(), m_base);
+			m_line = m_lexer->currentLine();
+			std::memmove(data, data + m_window, m_size - m_window);
+			m_base += m_window;
+			m_size -= m_window;
+			m_window = 0;
+			m_lexer.reset();
+		}
+
+		while (true)
+		{
+			if (!m_exhausted && m_size < m_capacity)
+			{
+				size_t count = read(data + m_size, m_capacity - m_size);
+				// The lexer stops at the first '\0', so nothing after it is ever needed.
+				const char* nul = static_cast<const char*>(std::memchr(data + m_size, '\0', count));
+				m_size += nul != nullptr ? nul - (data + m_size) : count;
+				m_exhausted = count == 0 || nul != nullptr;
+			}
+
+			if (m_insideComment)
+			{
+				const char* close = static_cast<const char*>(std::memchr(data, '}', m_size));
+				m_insideComment = close == nullptr;
+				discard(close != nullptr ? close - data + 1 : m_size);
+				if (m_insideComment && m_exhausted)
+					return false;
+				if (m_insideComment)
+					continue;
+			}
+
+			if (m_exhausted)
+				m_window = m_size;
+			else
+			{
+				// Find where the last comment opens or closes; a comment left open starts the skip state.
+				std::string_view buffered(data, m_size);
+				size_t outside = 0, open = std::string_view::npos;
+				for (size_t pos = buffered.find('{'); pos != std::string_view::npos; pos = buffered.find('{', outside))
+				{
+					size_t close = buffered.find('}', pos + 1);
+					if (close == std::string_view::npos)
+					{
+						open = pos;
+						break;
+					}
+					outside = close + 1;
+				}
+
+				if (open == 0)
+				{
+					m_insideComment = true;
+					discard(1);
+					continue;
+				}
+				if (open != std::string_view::npos)
+					m_window = open;
+				else
+				{
+					m_window = outside;
+					for (size_t pos = m_size; pos > outside; pos--)
+						if (endsToken(data[pos - 1]))
+						{
+							m_window = pos;
+							break;
+						}
+				}
+			}
+
+			if (m_window == 0)
+			{
+				if (m_exhausted)
+					return false;
+				if (m_size == m_capacity)
+					throw InputTooLarge("stream buffer");
+				continue;
+			}
+
+			m_lexer.emplace(SourceText{ std::string_view(data, m_window), m_line });
+			m_lexer->diagnostics().setLimit(m_diagnostics.size() < m_diagnostics.limit() ? m_diagnostics.limit() - m_diagnostics.size() : 0);
+			return true;
+		}
+	}
+
+	TokenView StreamLexer::nextTokenView()
+	{
+		while (true)
+		{
+			if (m_lexer)
+			{
+				TokenView token = m_lexer->nextTokenView();
+				if (token.kind != TokenKind::ENDOFFILE)
+				{
+					token.offset += m_base;
+					return token;
+				}
+			}
+			if (!refill())
+				return { TokenType::ENDOFFILE, TokenKind::ENDOFFILE, m_base + m_size, 0 };
+		}
+	}
+
+	Token StreamLexer::nextToken()
+	{
+		TokenView token = nextTokenView();
+		return { token.type, token.kind, value(token), token.number };
+	}
+
+	std::string_view StreamLexer::text(const TokenView& token) const
+	{
+		return { m_buffer.get() + (token.offset - m_base), token.length };
+	}
+
+	std::string StreamLexer::value(const TokenView& token) const
+	{
+		if (token.type == TokenType::ENDOFFILE)
+			return "end of file";
+		std::string lower(text(token));
+		std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+		return lower;
+	}
+}
@@ -0,0 +1,41 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace PL0
+{
+	ThreadPool::ThreadPool(size_t threadCount)
+	{
+		threadCount = std::max<size_t>(threadCount, 1);
+		m_workers.reserve(threadCount);
+		for (size_t i = 0; i < threadCount; i++)
+			m_workers.emplace_back([this] { workerLoop(); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_condition.notify_all();
+		for (auto& worker : m_workers)
+			worker.join();
+	}
+
+	void ThreadPool::workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+				if (m_tasks.empty())
+					return;
+				task = std::move(m_tasks.front());
+				m_tasks.pop();
+			}
+			task();
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#include "Trace.hpp"
+#include "LL1Parser.hpp"
+#include <algorithm>
+#include <bit>
+#include <format>
+
+namespace PL0
+{
+	Tracer::Tracer(TraceLevel level, size_t capacity)
+		: m_steps(std::bit_ceil(std::max<size_t>(capacity, 1))), m_level(level)
+	{
+	}
+
+	void Tracer::render(std::ostream& out, const TraceStep& step, const Grammar& grammar, std::string_view source)
+	{
+		std::string_view token = step.offset < source.size() ? source.substr(step.offset, step.length) : "#";
+		out << std::format("depth {:4}  at {:6} {:<10} ", step.depth, step.offset, token);
+		switch (step.event)
+		{
+		case TraceEvent::MATCH:
+			out << "match " << grammar.spelling(step.symbol);
+			break;
+		case TraceEvent::EXPAND:
+			out << "expand " << grammar.m_Rules[step.detail];
+			break;
+		case TraceEvent::ACTION:
+			out << "action {" << step.detail << "}";
+			break;
+		case TraceEvent::SYNTHESIZE:
+			out << "synthesize " << grammar.spelling(step.symbol);
+			break;
+		case TraceEvent::FAIL:
+			out << "fail on " << grammar.spelling(step.symbol);
+			break;
+		}
+		out << '\n';
+	}
+
+	void Tracer::dump(std::ostream& out, const Grammar& grammar, std::string_view source) const
+	{
+		out << std::format("Last {} of {} parse steps:\n", size(), m_recorded);
+		for (size_t i = 0; i < size(); i++)
+			render(out, (*this)[i], grammar, source);
+	}
+}
@@ -15,10 +15,44 @@ int main(int argc,char* argv[])
 		test2(inFilePath, outFilePath);
 	else if (test == "test3")
 		test3(inFilePath);
+	else if (test == "test3Static")
+		test3Static("test/test3/" + fileName + ".pl0");
 	else if (test == "test4")
 		test4(inFilePath, outFilePath);
 	else if (test == "test6")
 		test6(inFilePathtest6, outFilePath);
+	else if (test == "benchLexer")
+		benchLexer();
+	else if (test == "benchSymbols")
+		benchSymbols();
+	else if (test == "benchTokenize")
+		benchTokenize();
+	else if (test == "benchParallelLexer")
+		benchParallelLexer();
+	else if (test == "benchIncremental")
+		benchIncremental();
+	else if (test == "testStream")
+		testStream();
+	else if (test == "testDiagnostics")
+		testDiagnostics();
+	else if (test == "benchGrammar")
+		benchGrammar();
+	else if (test == "benchNamedGrammar")
+		benchNamedGrammar();
+	else if (test == "benchSemantic")
+		benchSemantic();
+	else if (test == "benchPredict")
+		benchPredict();
+	else if (test == "benchBatch")
+		benchBatch();
+	else if (test == "testAst")
+		testAst(inFilePath);
+	else if (test == "benchAst")
+		benchAst();
+	else if (test == "testPL0")
+		testPL0("test/test1/" + fileName + ".pl0");
+	else if (test == "generate")
+		generateParsers();
 	else
 		std::cerr << "Invalid input filename!" << std::endl;
 	